@@ -0,0 +1,80 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*
+ * Bump allocator for the trees of a parse. Objects of any type are carved
+ * out of chunks one after another and never freed alone, release() drops
+ * all of them at once and keeps the first chunk for the next parse. Only
+ * trivially destructible types belong here, no destructor ever runs.
+ */
+class Arena {
+private:
+    std::vector<char *> mChunks;
+    std::vector<size_t> mSizes;
+    size_t mChunkSize;
+    char *mCur;
+    char *mEnd;
+
+    //chunks double up to 1024 times the first size
+    void grow(size_t size) {
+        size_t chunk = mChunkSize << (mChunks.size() < 10 ? mChunks.size() : 10);
+        if (chunk < size) chunk = size;
+        char *data = (char *)malloc(chunk);
+        if (!data) throw std::bad_alloc();
+        mChunks.push_back(data);
+        mSizes.push_back(chunk);
+        mCur = data;
+        mEnd = data + chunk;
+    }
+
+    static char *align(char *p, size_t align) {
+        return (char *)(((uintptr_t)p + align-1) & ~(uintptr_t)(align-1));
+    }
+public:
+    Arena(size_t chunkSize = 1 << 16) : mChunkSize(chunkSize), mCur(NULL), mEnd(NULL) {}
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *alloc(size_t size, size_t alignment) {
+        char *p = align(mCur, alignment);
+        if (!mCur || p + size > mEnd) {
+            grow(size + alignment);
+            p = align(mCur, alignment);
+        }
+        mCur = p + size;
+        return p;
+    }
+
+    template <class T, class... Args>
+    T *make(Args&&... args) {
+        return new (alloc(sizeof(T), alignof(T))) T{std::forward<Args>(args)...};
+    }
+
+    //frees every object at once, the first chunk stays for reuse
+    void release() {
+        for (size_t i = 1; i < mChunks.size(); i++) free(mChunks[i]);
+        if (mChunks.empty()) return;
+        mChunks.resize(1);
+        mSizes.resize(1);
+        mCur = mChunks[0];
+        mEnd = mCur + mSizes[0];
+    }
+
+    size_t bytes() {
+        size_t res = 0;
+        for (size_t i = 0; i < mSizes.size(); i++) res += mSizes[i];
+        return res;
+    }
+
+    ~Arena() {
+        for (size_t i = 0; i < mChunks.size(); i++) free(mChunks[i]);
+    }
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "batch.hpp"
+#include "workpool.hpp"
+#include <string.h>
+
+//feeds the file at path to parser a window at a time, one window when it is mapped
+static void parseFile(const char *path, PushParser &parser, BatchResult &res) {
+    res.status = PARSE_ERROR;
+    res.lines = 0;
+    MmapReader in(path);
+    if (!in.valid()) {
+        res.message = string("cannot open: ") + strerror(in.error());
+        return;
+    }
+    int status = PARSE_MORE;
+    while (status == PARSE_MORE) {
+        size_t size;
+        const char *data = in.window(size);
+        if (!size && in.error()) {
+            res.message = string("cannot read: ") + strerror(in.error());
+            return;
+        }
+        status = size ? parser.feed(data, size) : parser.finish();
+        in.skip(size);
+    }
+    for (File *f = parser.result(); f; f = f->next) res.lines++;
+    res.diagnostics = parser.diagnostics();
+    res.status = res.diagnostics.empty() ? status : PARSE_ERROR;
+}
+
+static vector<BatchResult> run(const vector<string> &paths, const PackedTable *table, const map<int, int> *mapping,
+    int threads, const TreeVisitor &visit) {
+    vector<BatchResult> results(paths.size());
+    WorkPool pool(threads);
+    vector<Arena> arenas(pool.size());
+    vector<PushParser *> parsers(pool.size());
+    for (int w = 0; w < pool.size(); w++) {
+        parsers[w] = table ? new PushParser(arenas[w], *table, *mapping) : new PushParser(arenas[w]);
+        parsers[w]->recoverAt("\n");
+    }
+    pool.run(paths.size(), [&](int i, int worker) {
+        parsers[worker]->reset();
+        parseFile(paths[i].c_str(), *parsers[worker], results[i]);
+        if (visit && results[i].status == PARSE_DONE) visit(i, parsers[worker]->result());
+        arenas[worker].release();
+    });
+    for (int w = 0; w < pool.size(); w++) delete parsers[w];
+    return results;
+}
+
+vector<BatchResult> parseBatch(const vector<string> &paths, int threads, const TreeVisitor &visit) {
+    return run(paths, NULL, NULL, threads, visit);
+}
+
+vector<BatchResult> parseBatch(const vector<string> &paths, const PackedTable &table, const map<int, int> &mapping,
+    int threads, const TreeVisitor &visit) {
+    return run(paths, &table, &mapping, threads, visit);
+}
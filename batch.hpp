@@ -0,0 +1,31 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include "syntaxparser.hpp"
+#include <string>
+#include <functional>
+
+/*
+ * Checks many .lr files at once against one table shared read only by a
+ * pool of workers. Every worker owns a PushParser and the arena behind it,
+ * the arena is released between files, so a tree only lives for the visit
+ * of its file. Parsers recover at line ends, so a file reports all of its
+ * syntax errors at once, in its result and never by exiting.
+ */
+struct BatchResult {
+    int status;         //PARSE_DONE, or PARSE_ERROR for a file with errors or one that cannot be read
+    int lines;          //lines of the tree, without the ones dropped by recovery
+    string message;     //why the file could not be read
+    vector<Diagnostic> diagnostics;
+};
+
+//called on the worker while the tree of an error free file is alive, calls may overlap
+typedef function<void(int file, File *tree)> TreeVisitor;
+
+//against the hand written table
+vector<BatchResult> parseBatch(const vector<string> &paths, int threads, const TreeVisitor &visit = TreeVisitor());
+//against table and its id -> column mapping
+vector<BatchResult> parseBatch(const vector<string> &paths, const PackedTable &table, const map<int, int> &mapping,
+    int threads, const TreeVisitor &visit = TreeVisitor());
+
+#endif
@@ -0,0 +1,62 @@
+#include "lrgen.hpp"
+#include <string.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+/*
+ * Times LRTable construction for one grammar and appends one JSON line
+ *
+ *   {"grammar":..., "mode":..., "threads":..., "rules":..., "states":...,
+ *    "seconds":..., "states_per_sec":..., "peak_rss_kb":...}
+ *
+ * to the output. seconds is the fastest of the repeated builds, the peak
+ * RSS covers the whole process, so run one grammar per process.
+ *
+ *   bench [--merge] [--threads N] [--repeat R] [--out FILE] NAME GRAMMAR
+ */
+int main(int argc, char **argv) {
+    int mode = BUILD_LALR;
+    int threads = 1;
+    int repeat = 3;
+    const char *out = NULL;
+    const char *name = NULL;
+    const char *grammar = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--merge")) mode = BUILD_MERGE;
+        else if (!strcmp(argv[i], "--threads") && i+1 < argc) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--repeat") && i+1 < argc) repeat = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--out") && i+1 < argc) out = argv[++i];
+        else if (!name) name = argv[i];
+        else grammar = argv[i];
+    }
+    if (!grammar || repeat < 1) {
+        fprintf(stderr, "usage: %s [--merge] [--threads N] [--repeat R] [--out FILE] NAME GRAMMAR\n", argv[0]);
+        return -1;
+    }
+    Arena arena;
+    File *file = parse(new FileReader(grammar), arena);
+    double best = -1;
+    int states = 0;
+    int rules = 0;
+    for (int i = 0; i < repeat; i++) {
+        double start = wallSeconds();
+        LRTable table(file, mode, threads);
+        double time = wallSeconds() - start;
+        if (best < 0 || time < best) best = time;
+        states = table.getStats().states;
+        rules = table.getRules().size();
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    FILE *res = out ? fopen(out, "a") : stdout;
+    if (!res) {
+        fprintf(stderr, "cannot write %s\n", out);
+        return -1;
+    }
+    fprintf(res, "{\"grammar\":\"%s\",\"mode\":\"%s\",\"threads\":%d,\"rules\":%d,\"states\":%d,"
+        "\"seconds\":%.6f,\"states_per_sec\":%.0f,\"peak_rss_kb\":%ld}\n",
+        name, mode == BUILD_LALR ? "lalr" : "merge", threads, rules, states,
+        best, best > 0 ? states / best : 0.0, usage.ru_maxrss);
+    if (out) fclose(res);
+    return 0;
+}
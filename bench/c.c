@@ -0,0 +1,364 @@
+// ANSI C (C89) grammar, after the yacc grammar of K&R 2nd edition appendix A.
+// TYPEDEF_NAME is an identifier the lexer knows to be a typedef name.
+
+#define END                         0
+#define IDENTIFIER                  1
+#define CONSTANT                    2
+#define STRING_LITERAL              3
+#define LPAREN                      4
+#define RPAREN                      5
+#define LBRACKET                    6
+#define RBRACKET                    7
+#define DOT                         8
+#define PTR_OP                      9
+#define INC_OP                      10
+#define DEC_OP                      11
+#define COMMA                       12
+#define SIZEOF                      13
+#define AMP                         14
+#define STAR                        15
+#define PLUS                        16
+#define MINUS                       17
+#define TILDE                       18
+#define NOT                         19
+#define SLASH                       20
+#define PERCENT                     21
+#define LEFT_OP                     22
+#define RIGHT_OP                    23
+#define LT                          24
+#define GT                          25
+#define LE_OP                       26
+#define GE_OP                       27
+#define EQ_OP                       28
+#define NE_OP                       29
+#define CARET                       30
+#define PIPE                        31
+#define AND_OP                      32
+#define OR_OP                       33
+#define QUESTION                    34
+#define COLON                       35
+#define ASSIGN                      36
+#define MUL_ASSIGN                  37
+#define DIV_ASSIGN                  38
+#define MOD_ASSIGN                  39
+#define ADD_ASSIGN                  40
+#define SUB_ASSIGN                  41
+#define LEFT_ASSIGN                 42
+#define RIGHT_ASSIGN                43
+#define AND_ASSIGN                  44
+#define XOR_ASSIGN                  45
+#define OR_ASSIGN                   46
+#define SEMI                        47
+#define TYPEDEF                     48
+#define EXTERN                      49
+#define STATIC                      50
+#define AUTO                        51
+#define REGISTER                    52
+#define VOID                        53
+#define CHAR                        54
+#define SHORT                       55
+#define INT                         56
+#define LONG                        57
+#define FLOAT                       58
+#define DOUBLE                      59
+#define SIGNED                      60
+#define UNSIGNED                    61
+#define TYPEDEF_NAME                62
+#define LBRACE                      63
+#define RBRACE                      64
+#define STRUCT                      65
+#define UNION                       66
+#define ENUM                        67
+#define CONST                       68
+#define VOLATILE                    69
+#define ELLIPSIS                    70
+#define CASE                        71
+#define DEFAULT                     72
+#define IF                          73
+#define ELSE                        74
+#define SWITCH                      75
+#define WHILE                       76
+#define DO                          77
+#define FOR                         78
+#define GOTO                        79
+#define CONTINUE                    80
+#define BREAK                       81
+#define RETURN                      82
+
+#define FILE                        83
+#define PRIMARY                     84
+#define POSTFIX                     85
+#define ARGUMENTS                   86
+#define UNARY                       87
+#define UNARY_OPERATOR              88
+#define CAST                        89
+#define MULTIPLICATIVE              90
+#define ADDITIVE                    91
+#define SHIFT                       92
+#define RELATIONAL                  93
+#define EQUALITY                    94
+#define AND                         95
+#define XOR                         96
+#define OR                          97
+#define LOGICAL_AND                 98
+#define LOGICAL_OR                  99
+#define CONDITIONAL                 100
+#define ASSIGNMENT                  101
+#define ASSIGNMENT_OPERATOR         102
+#define EXPRESSION                  103
+#define CONSTANT_EXPRESSION         104
+#define DECLARATION                 105
+#define SPECIFIERS                  106
+#define INIT_DECLARATORS            107
+#define INIT_DECLARATOR             108
+#define STORAGE_CLASS               109
+#define TYPE_SPECIFIER              110
+#define STRUCT_OR_UNION_SPECIFIER   111
+#define STRUCT_OR_UNION             112
+#define STRUCT_DECLARATIONS         113
+#define STRUCT_DECLARATION          114
+#define SPECIFIER_QUALIFIERS        115
+#define STRUCT_DECLARATORS          116
+#define STRUCT_DECLARATOR           117
+#define ENUM_SPECIFIER              118
+#define ENUMERATORS                 119
+#define ENUMERATOR                  120
+#define TYPE_QUALIFIER              121
+#define DECLARATOR                  122
+#define DIRECT_DECLARATOR           123
+#define POINTER                     124
+#define TYPE_QUALIFIERS             125
+#define PARAMETER_TYPES             126
+#define PARAMETERS                  127
+#define PARAMETER                   128
+#define IDENTIFIERS                 129
+#define TYPE_NAME                   130
+#define ABSTRACT_DECLARATOR         131
+#define DIRECT_ABSTRACT_DECLARATOR  132
+#define INITIALIZER                 133
+#define INITIALIZERS                134
+#define STATEMENT                   135
+#define LABELED                     136
+#define COMPOUND                    137
+#define DECLARATIONS                138
+#define STATEMENTS                  139
+#define EXPRESSION_STATEMENT        140
+#define SELECTION                   141
+#define ITERATION                   142
+#define JUMP                        143
+#define TRANSLATION_UNIT            144
+#define EXTERNAL_DECLARATION        145
+#define FUNCTION_DEFINITION         146
+
+/FILE>/TRANSLATION_UNIT/END
+/PRIMARY>/IDENTIFIER
+/PRIMARY>/CONSTANT
+/PRIMARY>/STRING_LITERAL
+/PRIMARY>/LPAREN/EXPRESSION/RPAREN
+/POSTFIX>/PRIMARY
+/POSTFIX>/POSTFIX/LBRACKET/EXPRESSION/RBRACKET
+/POSTFIX>/POSTFIX/LPAREN/RPAREN
+/POSTFIX>/POSTFIX/LPAREN/ARGUMENTS/RPAREN
+/POSTFIX>/POSTFIX/DOT/IDENTIFIER
+/POSTFIX>/POSTFIX/PTR_OP/IDENTIFIER
+/POSTFIX>/POSTFIX/INC_OP
+/POSTFIX>/POSTFIX/DEC_OP
+/ARGUMENTS>/ASSIGNMENT
+/ARGUMENTS>/ARGUMENTS/COMMA/ASSIGNMENT
+/UNARY>/POSTFIX
+/UNARY>/INC_OP/UNARY
+/UNARY>/DEC_OP/UNARY
+/UNARY>/UNARY_OPERATOR/CAST
+/UNARY>/SIZEOF/UNARY
+/UNARY>/SIZEOF/LPAREN/TYPE_NAME/RPAREN
+/UNARY_OPERATOR>/AMP
+/UNARY_OPERATOR>/STAR
+/UNARY_OPERATOR>/PLUS
+/UNARY_OPERATOR>/MINUS
+/UNARY_OPERATOR>/TILDE
+/UNARY_OPERATOR>/NOT
+/CAST>/UNARY
+/CAST>/LPAREN/TYPE_NAME/RPAREN/CAST
+/MULTIPLICATIVE>/CAST
+/MULTIPLICATIVE>/MULTIPLICATIVE/STAR/CAST
+/MULTIPLICATIVE>/MULTIPLICATIVE/SLASH/CAST
+/MULTIPLICATIVE>/MULTIPLICATIVE/PERCENT/CAST
+/ADDITIVE>/MULTIPLICATIVE
+/ADDITIVE>/ADDITIVE/PLUS/MULTIPLICATIVE
+/ADDITIVE>/ADDITIVE/MINUS/MULTIPLICATIVE
+/SHIFT>/ADDITIVE
+/SHIFT>/SHIFT/LEFT_OP/ADDITIVE
+/SHIFT>/SHIFT/RIGHT_OP/ADDITIVE
+/RELATIONAL>/SHIFT
+/RELATIONAL>/RELATIONAL/LT/SHIFT
+/RELATIONAL>/RELATIONAL/GT/SHIFT
+/RELATIONAL>/RELATIONAL/LE_OP/SHIFT
+/RELATIONAL>/RELATIONAL/GE_OP/SHIFT
+/EQUALITY>/RELATIONAL
+/EQUALITY>/EQUALITY/EQ_OP/RELATIONAL
+/EQUALITY>/EQUALITY/NE_OP/RELATIONAL
+/AND>/EQUALITY
+/AND>/AND/AMP/EQUALITY
+/XOR>/AND
+/XOR>/XOR/CARET/AND
+/OR>/XOR
+/OR>/OR/PIPE/XOR
+/LOGICAL_AND>/OR
+/LOGICAL_AND>/LOGICAL_AND/AND_OP/OR
+/LOGICAL_OR>/LOGICAL_AND
+/LOGICAL_OR>/LOGICAL_OR/OR_OP/LOGICAL_AND
+/CONDITIONAL>/LOGICAL_OR
+/CONDITIONAL>/LOGICAL_OR/QUESTION/EXPRESSION/COLON/CONDITIONAL
+/ASSIGNMENT>/CONDITIONAL
+/ASSIGNMENT>/UNARY/ASSIGNMENT_OPERATOR/ASSIGNMENT
+/ASSIGNMENT_OPERATOR>/ASSIGN
+/ASSIGNMENT_OPERATOR>/MUL_ASSIGN
+/ASSIGNMENT_OPERATOR>/DIV_ASSIGN
+/ASSIGNMENT_OPERATOR>/MOD_ASSIGN
+/ASSIGNMENT_OPERATOR>/ADD_ASSIGN
+/ASSIGNMENT_OPERATOR>/SUB_ASSIGN
+/ASSIGNMENT_OPERATOR>/LEFT_ASSIGN
+/ASSIGNMENT_OPERATOR>/RIGHT_ASSIGN
+/ASSIGNMENT_OPERATOR>/AND_ASSIGN
+/ASSIGNMENT_OPERATOR>/XOR_ASSIGN
+/ASSIGNMENT_OPERATOR>/OR_ASSIGN
+/EXPRESSION>/ASSIGNMENT
+/EXPRESSION>/EXPRESSION/COMMA/ASSIGNMENT
+/CONSTANT_EXPRESSION>/CONDITIONAL
+/DECLARATION>/SPECIFIERS/SEMI
+/DECLARATION>/SPECIFIERS/INIT_DECLARATORS/SEMI
+/SPECIFIERS>/STORAGE_CLASS
+/SPECIFIERS>/STORAGE_CLASS/SPECIFIERS
+/SPECIFIERS>/TYPE_SPECIFIER
+/SPECIFIERS>/TYPE_SPECIFIER/SPECIFIERS
+/SPECIFIERS>/TYPE_QUALIFIER
+/SPECIFIERS>/TYPE_QUALIFIER/SPECIFIERS
+/INIT_DECLARATORS>/INIT_DECLARATOR
+/INIT_DECLARATORS>/INIT_DECLARATORS/COMMA/INIT_DECLARATOR
+/INIT_DECLARATOR>/DECLARATOR
+/INIT_DECLARATOR>/DECLARATOR/ASSIGN/INITIALIZER
+/STORAGE_CLASS>/TYPEDEF
+/STORAGE_CLASS>/EXTERN
+/STORAGE_CLASS>/STATIC
+/STORAGE_CLASS>/AUTO
+/STORAGE_CLASS>/REGISTER
+/TYPE_SPECIFIER>/VOID
+/TYPE_SPECIFIER>/CHAR
+/TYPE_SPECIFIER>/SHORT
+/TYPE_SPECIFIER>/INT
+/TYPE_SPECIFIER>/LONG
+/TYPE_SPECIFIER>/FLOAT
+/TYPE_SPECIFIER>/DOUBLE
+/TYPE_SPECIFIER>/SIGNED
+/TYPE_SPECIFIER>/UNSIGNED
+/TYPE_SPECIFIER>/STRUCT_OR_UNION_SPECIFIER
+/TYPE_SPECIFIER>/ENUM_SPECIFIER
+/TYPE_SPECIFIER>/TYPEDEF_NAME
+/STRUCT_OR_UNION_SPECIFIER>/STRUCT_OR_UNION/IDENTIFIER/LBRACE/STRUCT_DECLARATIONS/RBRACE
+/STRUCT_OR_UNION_SPECIFIER>/STRUCT_OR_UNION/LBRACE/STRUCT_DECLARATIONS/RBRACE
+/STRUCT_OR_UNION_SPECIFIER>/STRUCT_OR_UNION/IDENTIFIER
+/STRUCT_OR_UNION>/STRUCT
+/STRUCT_OR_UNION>/UNION
+/STRUCT_DECLARATIONS>/STRUCT_DECLARATION
+/STRUCT_DECLARATIONS>/STRUCT_DECLARATIONS/STRUCT_DECLARATION
+/STRUCT_DECLARATION>/SPECIFIER_QUALIFIERS/STRUCT_DECLARATORS/SEMI
+/SPECIFIER_QUALIFIERS>/TYPE_SPECIFIER/SPECIFIER_QUALIFIERS
+/SPECIFIER_QUALIFIERS>/TYPE_SPECIFIER
+/SPECIFIER_QUALIFIERS>/TYPE_QUALIFIER/SPECIFIER_QUALIFIERS
+/SPECIFIER_QUALIFIERS>/TYPE_QUALIFIER
+/STRUCT_DECLARATORS>/STRUCT_DECLARATOR
+/STRUCT_DECLARATORS>/STRUCT_DECLARATORS/COMMA/STRUCT_DECLARATOR
+/STRUCT_DECLARATOR>/DECLARATOR
+/STRUCT_DECLARATOR>/COLON/CONSTANT_EXPRESSION
+/STRUCT_DECLARATOR>/DECLARATOR/COLON/CONSTANT_EXPRESSION
+/ENUM_SPECIFIER>/ENUM/LBRACE/ENUMERATORS/RBRACE
+/ENUM_SPECIFIER>/ENUM/IDENTIFIER/LBRACE/ENUMERATORS/RBRACE
+/ENUM_SPECIFIER>/ENUM/IDENTIFIER
+/ENUMERATORS>/ENUMERATOR
+/ENUMERATORS>/ENUMERATORS/COMMA/ENUMERATOR
+/ENUMERATOR>/IDENTIFIER
+/ENUMERATOR>/IDENTIFIER/ASSIGN/CONSTANT_EXPRESSION
+/TYPE_QUALIFIER>/CONST
+/TYPE_QUALIFIER>/VOLATILE
+/DECLARATOR>/POINTER/DIRECT_DECLARATOR
+/DECLARATOR>/DIRECT_DECLARATOR
+/DIRECT_DECLARATOR>/IDENTIFIER
+/DIRECT_DECLARATOR>/LPAREN/DECLARATOR/RPAREN
+/DIRECT_DECLARATOR>/DIRECT_DECLARATOR/LBRACKET/CONSTANT_EXPRESSION/RBRACKET
+/DIRECT_DECLARATOR>/DIRECT_DECLARATOR/LBRACKET/RBRACKET
+/DIRECT_DECLARATOR>/DIRECT_DECLARATOR/LPAREN/PARAMETER_TYPES/RPAREN
+/DIRECT_DECLARATOR>/DIRECT_DECLARATOR/LPAREN/IDENTIFIERS/RPAREN
+/DIRECT_DECLARATOR>/DIRECT_DECLARATOR/LPAREN/RPAREN
+/POINTER>/STAR
+/POINTER>/STAR/TYPE_QUALIFIERS
+/POINTER>/STAR/POINTER
+/POINTER>/STAR/TYPE_QUALIFIERS/POINTER
+/TYPE_QUALIFIERS>/TYPE_QUALIFIER
+/TYPE_QUALIFIERS>/TYPE_QUALIFIERS/TYPE_QUALIFIER
+/PARAMETER_TYPES>/PARAMETERS
+/PARAMETER_TYPES>/PARAMETERS/COMMA/ELLIPSIS
+/PARAMETERS>/PARAMETER
+/PARAMETERS>/PARAMETERS/COMMA/PARAMETER
+/PARAMETER>/SPECIFIERS/DECLARATOR
+/PARAMETER>/SPECIFIERS/ABSTRACT_DECLARATOR
+/PARAMETER>/SPECIFIERS
+/IDENTIFIERS>/IDENTIFIER
+/IDENTIFIERS>/IDENTIFIERS/COMMA/IDENTIFIER
+/TYPE_NAME>/SPECIFIER_QUALIFIERS
+/TYPE_NAME>/SPECIFIER_QUALIFIERS/ABSTRACT_DECLARATOR
+/ABSTRACT_DECLARATOR>/POINTER
+/ABSTRACT_DECLARATOR>/DIRECT_ABSTRACT_DECLARATOR
+/ABSTRACT_DECLARATOR>/POINTER/DIRECT_ABSTRACT_DECLARATOR
+/DIRECT_ABSTRACT_DECLARATOR>/LPAREN/ABSTRACT_DECLARATOR/RPAREN
+/DIRECT_ABSTRACT_DECLARATOR>/LBRACKET/RBRACKET
+/DIRECT_ABSTRACT_DECLARATOR>/LBRACKET/CONSTANT_EXPRESSION/RBRACKET
+/DIRECT_ABSTRACT_DECLARATOR>/DIRECT_ABSTRACT_DECLARATOR/LBRACKET/RBRACKET
+/DIRECT_ABSTRACT_DECLARATOR>/DIRECT_ABSTRACT_DECLARATOR/LBRACKET/CONSTANT_EXPRESSION/RBRACKET
+/DIRECT_ABSTRACT_DECLARATOR>/LPAREN/RPAREN
+/DIRECT_ABSTRACT_DECLARATOR>/LPAREN/PARAMETER_TYPES/RPAREN
+/DIRECT_ABSTRACT_DECLARATOR>/DIRECT_ABSTRACT_DECLARATOR/LPAREN/RPAREN
+/DIRECT_ABSTRACT_DECLARATOR>/DIRECT_ABSTRACT_DECLARATOR/LPAREN/PARAMETER_TYPES/RPAREN
+/INITIALIZER>/ASSIGNMENT
+/INITIALIZER>/LBRACE/INITIALIZERS/RBRACE
+/INITIALIZER>/LBRACE/INITIALIZERS/COMMA/RBRACE
+/INITIALIZERS>/INITIALIZER
+/INITIALIZERS>/INITIALIZERS/COMMA/INITIALIZER
+/STATEMENT>/LABELED
+/STATEMENT>/COMPOUND
+/STATEMENT>/EXPRESSION_STATEMENT
+/STATEMENT>/SELECTION
+/STATEMENT>/ITERATION
+/STATEMENT>/JUMP
+/LABELED>/IDENTIFIER/COLON/STATEMENT
+/LABELED>/CASE/CONSTANT_EXPRESSION/COLON/STATEMENT
+/LABELED>/DEFAULT/COLON/STATEMENT
+/COMPOUND>/LBRACE/RBRACE
+/COMPOUND>/LBRACE/STATEMENTS/RBRACE
+/COMPOUND>/LBRACE/DECLARATIONS/RBRACE
+/COMPOUND>/LBRACE/DECLARATIONS/STATEMENTS/RBRACE
+/DECLARATIONS>/DECLARATION
+/DECLARATIONS>/DECLARATIONS/DECLARATION
+/STATEMENTS>/STATEMENT
+/STATEMENTS>/STATEMENTS/STATEMENT
+/EXPRESSION_STATEMENT>/SEMI
+/EXPRESSION_STATEMENT>/EXPRESSION/SEMI
+/SELECTION>/IF/LPAREN/EXPRESSION/RPAREN/STATEMENT
+/SELECTION>/IF/LPAREN/EXPRESSION/RPAREN/STATEMENT/ELSE/STATEMENT
+/SELECTION>/SWITCH/LPAREN/EXPRESSION/RPAREN/STATEMENT
+/ITERATION>/WHILE/LPAREN/EXPRESSION/RPAREN/STATEMENT
+/ITERATION>/DO/STATEMENT/WHILE/LPAREN/EXPRESSION/RPAREN/SEMI
+/ITERATION>/FOR/LPAREN/EXPRESSION_STATEMENT/EXPRESSION_STATEMENT/RPAREN/STATEMENT
+/ITERATION>/FOR/LPAREN/EXPRESSION_STATEMENT/EXPRESSION_STATEMENT/EXPRESSION/RPAREN/STATEMENT
+/JUMP>/GOTO/IDENTIFIER/SEMI
+/JUMP>/CONTINUE/SEMI
+/JUMP>/BREAK/SEMI
+/JUMP>/RETURN/SEMI
+/JUMP>/RETURN/EXPRESSION/SEMI
+/TRANSLATION_UNIT>/EXTERNAL_DECLARATION
+/TRANSLATION_UNIT>/TRANSLATION_UNIT/EXTERNAL_DECLARATION
+/EXTERNAL_DECLARATION>/FUNCTION_DEFINITION
+/EXTERNAL_DECLARATION>/DECLARATION
+/FUNCTION_DEFINITION>/SPECIFIERS/DECLARATOR/DECLARATIONS/COMPOUND
+/FUNCTION_DEFINITION>/SPECIFIERS/DECLARATOR/COMPOUND
+/FUNCTION_DEFINITION>/DECLARATOR/DECLARATIONS/COMPOUND
+/FUNCTION_DEFINITION>/DECLARATOR/COMPOUND
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+using namespace std;
+
+/*
+ * Synthetic grammars in the .lr format, written to stdout:
+ *
+ *   grammargen ladder N    expression with N precedence levels
+ *   grammargen list N      N right recursive lists, each running into the next
+ *   grammargen alts N      one nonterminal with N three symbol alternatives
+ *   grammargen chain N     N nonterminals deep chain of unit rules
+ *
+ * Rule 0 is the start rule S' -> S $, ids are numbered from 0 in order of
+ * first use. No newline follows the last rule, the bootstrap grammar does
+ * not allow one.
+ */
+static int nextId = 0;
+static vector<vector<int>> rules;
+
+static int symbol() {
+    return nextId++;
+}
+
+static void rule(int from, const vector<int> &to) {
+    vector<int> r(1, from);
+    r.insert(r.end(), to.begin(), to.end());
+    rules.push_back(r);
+}
+
+//E0 -> E0 op0 E1 | E1, ..., EN -> ( E0 ) | id
+static int ladder(int n) {
+    vector<int> levels(n+1);
+    for (int i = 0; i <= n; i++) levels[i] = symbol();
+    for (int i = 0; i < n; i++) {
+        int op = symbol();
+        rule(levels[i], {levels[i], op, levels[i+1]});
+        rule(levels[i], {levels[i+1]});
+    }
+    int open = symbol(), close = symbol(), id = symbol();
+    rule(levels[n], {open, levels[0], close});
+    rule(levels[n], {id});
+    return levels[0];
+}
+
+//Lk -> tk Lk | tk Lk+1, LN -> tN LN | tN
+static int list(int n) {
+    vector<int> lists(n);
+    for (int i = 0; i < n; i++) lists[i] = symbol();
+    for (int i = 0; i < n; i++) {
+        int t = symbol();
+        rule(lists[i], {t, lists[i]});
+        if (i+1 < n) rule(lists[i], {t, lists[i+1]});
+        else rule(lists[i], {t});
+    }
+    return lists[0];
+}
+
+//A -> px qy rz for the digits x y z of 0..N-1 in base k, a trie of prefixes
+static int alts(int n) {
+    int k = 1;
+    while (k*k*k < n) k++;
+    int a = symbol();
+    vector<int> p(k), q(k), r(k);
+    for (int i = 0; i < k; i++) {
+        p[i] = symbol();
+        q[i] = symbol();
+        r[i] = symbol();
+    }
+    for (int i = 0; i < n; i++) {
+        rule(a, {p[i/k/k%k], q[i/k%k], r[i%k]});
+    }
+    return a;
+}
+
+//Ck -> Ck+1 | tk Ck, CN -> x; every closure pulls in the rest of the chain
+static int chain(int n) {
+    vector<int> links(n+1);
+    for (int i = 0; i <= n; i++) links[i] = symbol();
+    for (int i = 0; i < n; i++) {
+        int t = symbol();
+        rule(links[i], {links[i+1]});
+        rule(links[i], {t, links[i]});
+    }
+    rule(links[n], {symbol()});
+    return links[0];
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3 || atoi(argv[2]) < 1) {
+        fprintf(stderr, "usage: %s ladder|list|alts|chain N\n", argv[0]);
+        return -1;
+    }
+    int n = atoi(argv[2]);
+    int start = symbol();
+    int end = symbol();
+    rules.push_back(vector<int>());     //start rule, filled in below
+    int top;
+    if (!strcmp(argv[1], "ladder")) top = ladder(n);
+    else if (!strcmp(argv[1], "list")) top = list(n);
+    else if (!strcmp(argv[1], "alts")) top = alts(n);
+    else if (!strcmp(argv[1], "chain")) top = chain(n);
+    else {
+        fprintf(stderr, "unknown grammar %s\n", argv[1]);
+        return -1;
+    }
+    rules[0] = {start, top, end};
+    for (int i = 0; i < rules.size(); i++) {
+        printf("%s/%d>", i ? "\n" : "", rules[i][0]);
+        for (int j = 1; j < rules[i].size(); j++) printf("/%d", rules[i][j]);
+    }
+    return 0;
+}
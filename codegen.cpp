@@ -0,0 +1,97 @@
+#include "codegen.hpp"
+
+static void writeState(FILE *out, int state, const vector<action> &row, int rule, const vector<int> &ids, int terminals) {
+    fprintf(out, "s%d:\n", state);
+    fprintf(out, "    PUSH(%d);\n", state);
+    if (rule >= 0) {
+        fprintf(out, "    goto r%d;\n", rule);
+        return;
+    }
+    fprintf(out, "    switch (tok) {\n");
+    //cases with the same action share one body
+    vector<bool> done(terminals, false);
+    for (int c = 0; c < terminals; c++) {
+        if (done[c] || row[c].type == FAIL) continue;
+        for (int k = c; k < terminals; k++) {
+            if (row[k].type != row[c].type || row[k].num != row[c].num) continue;
+            fprintf(out, "    case %d:\n", ids[k]);
+            done[k] = true;
+        }
+        switch (row[c].type) {
+        case SHIFT:
+            fprintf(out, "        tok = next(ctx);\n        goto s%d;\n", row[c].num);
+            break;
+        case REDUCE:
+            fprintf(out, "        goto r%d;\n", row[c].num);
+            break;
+        case ACCEPT:
+            fprintf(out, "        free(stack);\n        return 0;\n");
+            break;
+        }
+    }
+    fprintf(out, "    default:\n        goto error;\n    }\n");
+}
+
+bool writeDirectParser(const char *path, LRTable &table, const char *name) {
+    const vector<vector<action>> &t = table.getTable();
+    const vector<int> &defaults = table.getDefaults();
+    const SymbolTable &symbols = table.getSymbols();
+    const Rules &rules = table.getRules();
+    int terminals = symbols.terminals();
+    int columns = symbols.size();
+    vector<int> ids(columns);
+    for (int c = 0; c < columns; c++) ids[c] = symbols.id(c);
+    FILE *out = fopen(path, "w");
+    if (!out) return false;
+    fprintf(out, "//generated from an LRTable with %d states, do not edit\n", (int)t.size());
+    fprintf(out, "#include <stdlib.h>\n\n");
+    fprintf(out, "#define PUSH(s) do { \\\n"
+                 "    if (sp == cap) stack = (int *)realloc(stack, (cap *= 2) * sizeof(int)); \\\n"
+                 "    stack[sp++] = (s); \\\n"
+                 "} while (0)\n\n");
+    fprintf(out, "int %s(int (*next)(void *ctx), void (*reduce)(int rule, void *ctx), void *ctx) {\n", name);
+    fprintf(out, "    int cap = 64;\n    int sp = 0;\n    int *stack = (int *)malloc(cap * sizeof(int));\n");
+    fprintf(out, "    unsigned top;\n    int tok = next(ctx);\n");
+    //label tables for gotos, covering only the states that have one
+    for (int c = terminals; c < columns; c++) {
+        int lo = -1, hi = -1;
+        for (int s = 0; s < t.size(); s++) {
+            if (t[s][c].type != GOTO) continue;
+            if (lo < 0) lo = s;
+            hi = s;
+        }
+        if (lo < 0) continue;
+        fprintf(out, "    static void *const goto%d[] = {", ids[c]);
+        for (int s = lo; s <= hi; s++) {
+            if (t[s][c].type == GOTO) fprintf(out, "%s&&s%d", s == lo ? "" : ", ", t[s][c].num);
+            else fprintf(out, "%s&&error", s == lo ? "" : ", ");
+        }
+        fprintf(out, "};\n");
+        fprintf(out, "    const unsigned goto%dLow = %d;\n", ids[c], lo);
+    }
+    fprintf(out, "    goto s0;\n");
+    for (int s = 0; s < t.size(); s++) {
+        writeState(out, s, t[s], defaults[s], ids, terminals);
+    }
+    for (int r = 0; r < rules.size(); r++) {
+        int col = rules[r]->getFrom();
+        int from = ids[col];
+        fprintf(out, "r%d:\n", r);
+        fprintf(out, "    if (reduce) reduce(%d, ctx);\n", r);
+        fprintf(out, "    sp -= %d;\n", rules[r]->getSize());
+        bool reachable = false;
+        for (int s = 0; s < t.size(); s++) {
+            if (t[s][col].type == GOTO) reachable = true;
+        }
+        if (!reachable) {
+            fprintf(out, "    goto error;\n");
+            continue;
+        }
+        fprintf(out, "    if (sp < 1) goto error;\n");
+        fprintf(out, "    top = (unsigned)stack[sp-1] - goto%dLow;\n", from);
+        fprintf(out, "    if (top >= sizeof(goto%d) / sizeof(goto%d[0])) goto error;\n", from, from);
+        fprintf(out, "    goto *goto%d[top];\n", from);
+    }
+    fprintf(out, "error:\n    free(stack);\n    return -1;\n}\n");
+    return fclose(out) == 0;
+}
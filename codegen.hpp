@@ -0,0 +1,19 @@
+#ifndef CODEGEN_HPP
+#define CODEGEN_HPP
+
+#include "lrgen.hpp"
+
+/*
+ * Writes table as a standalone direct-coded parser, one labelled block
+ * per state switching on the lookahead and one per rule popping its
+ * right side, with nonterminal gotos dispatched through label tables
+ * (GCC labels as values). The generated function is
+ *
+ *   int name(int (*next)(void *ctx), void (*reduce)(int rule, void *ctx), void *ctx);
+ *
+ * next yields grammar ids of terminals, reduce (may be NULL) sees every
+ * reduction, and the result is 0 on accept and -1 on a syntax error.
+ */
+bool writeDirectParser(const char *path, LRTable &table, const char *name);
+
+#endif
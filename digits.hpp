@@ -0,0 +1,47 @@
+#ifndef DIGITS_HPP
+#define DIGITS_HPP
+
+#include <stddef.h>
+#if !defined(LRGEN_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#elif !defined(LRGEN_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * Length of the run of ASCII digits at the start of p[0, n). Whole blocks
+ * are classified at once, 32 bytes with AVX2 or 16 with SSE2, the rest
+ * byte by byte; build with LRGEN_NO_SIMD for the scalar loop alone.
+ */
+static inline size_t digitRunScalar(const char *p, size_t n) {
+    size_t i = 0;
+    while (i < n && (unsigned char)(p[i] - '0') < 10) i++;
+    return i;
+}
+
+static inline size_t digitRun(const char *p, size_t n) {
+    size_t i = 0;
+#if !defined(LRGEN_NO_SIMD) && defined(__AVX2__)
+    //signed compares: '0'-1 < c < '9'+1
+    const __m256i lo = _mm256_set1_epi8('0' - 1);
+    const __m256i hi = _mm256_set1_epi8('9' + 1);
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        __m256i in = _mm256_and_si256(_mm256_cmpgt_epi8(v, lo), _mm256_cmpgt_epi8(hi, v));
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(in);
+        if (mask) return i + __builtin_ctz(mask);
+    }
+#elif !defined(LRGEN_NO_SIMD) && defined(__SSE2__)
+    const __m128i lo = _mm_set1_epi8('0' - 1);
+    const __m128i hi = _mm_set1_epi8('9' + 1);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+        __m128i in = _mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi));
+        unsigned mask = ~(unsigned)_mm_movemask_epi8(in) & 0xffff;
+        if (mask) return i + __builtin_ctz(mask);
+    }
+#endif
+    return i + digitRunScalar(p + i, n - i);
+}
+
+#endif
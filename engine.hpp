@@ -0,0 +1,167 @@
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+#include "lrgen.hpp"
+#include "packedtable.hpp"
+#include <functional>
+
+/*
+ * Table driven parsing for any grammar, with semantic values of type V.
+ *
+ * ActionRegistry holds what every rule reduces to, keyed by
+ * Rule::getIndex(). An action sees the values of the rule's right side in
+ * order and returns the value of its left side; a rule without one
+ * passes on its first value, or V() when it is empty.
+ *
+ * Engine is a push parser over a PackedTable. Tokens come in by table
+ * column (LRTable::getIndex or TableImage::column of their id) together
+ * with their value. Every token is taken as far as it goes, default
+ * reductions included, and a reduction pops the whole right side at once.
+ */
+template <class V>
+class ActionRegistry {
+public:
+    typedef function<V(V *rhs)> Action;
+private:
+    vector<int> mFrom;          //rule -> column of its left side
+    vector<int> mSizes;         //rule -> length of its right side
+    vector<Action> mActions;
+public:
+    //rules of an LRTable, their left sides are already columns
+    ActionRegistry(const Rules &rules) : mFrom(rules.size()), mSizes(rules.size()), mActions(rules.size()) {
+        for (int i = 0; i < rules.size(); i++) {
+            mFrom[rules[i]->getIndex()] = rules[i]->getFrom();
+            mSizes[rules[i]->getIndex()] = rules[i]->getSize();
+        }
+    }
+    ActionRegistry(const vector<int> &from, const vector<int> &sizes)
+        : mFrom(from), mSizes(sizes), mActions(from.size()) {}
+
+    void on(int rule, Action action) {
+        mActions[rule] = action;
+    }
+    int rules() const {
+        return mFrom.size();
+    }
+    int from(int rule) const {
+        return mFrom[rule];
+    }
+    int size(int rule) const {
+        return mSizes[rule];
+    }
+    V reduce(int rule, V *rhs) const {
+        if (mActions[rule]) return mActions[rule](rhs);
+        return mSizes[rule] ? rhs[0] : V();
+    }
+};
+
+template <class V>
+class Engine {
+private:
+    const PackedTable &mTable;
+    const ActionRegistry<V> &mActions;
+    int mStart;
+    int mEnd;
+    vector<int> mStates;        //start state at the bottom, one more than values
+    vector<V> mValues;
+    int mStatus;
+    int mEntry;
+
+    //reduces by rule and takes the goto on its left side
+    bool reduceBy(int rule) {
+        int n = mActions.size(rule);
+        V value = mActions.reduce(rule, mValues.data() + mValues.size() - n);
+        mValues.resize(mValues.size() - n);
+        mStates.resize(mStates.size() - n);
+        action act = mTable.lookup(mStates.back(), mActions.from(rule));
+        if (act.type != GOTO) {
+            mEntry = mActions.from(rule);
+            return false;
+        }
+        mStates.push_back(act.num);
+        mValues.push_back(std::move(value));
+        return true;
+    }
+
+    int settle() {
+        int rule;
+        while ((rule = mTable.defaultReduce(mStates.back())) >= 0) {
+            if (!reduceBy(rule)) return mStatus = PARSE_ERROR;
+        }
+        return mStatus;
+    }
+public:
+    //end is the column of the end of input marker
+    Engine(const PackedTable &table, const ActionRegistry<V> &actions, int end, int start = 0)
+        : mTable(table), mActions(actions), mStart(start), mEnd(end) {
+        reset();
+    }
+
+    void reset() {
+        mStates.assign(1, mStart);
+        mValues.clear();
+        mStatus = PARSE_MORE;
+        mEntry = 0;
+        settle();
+    }
+
+    //PARSE_MORE while more tokens are welcome, PARSE_DONE or PARSE_ERROR after
+    int feed(int column, V value) {
+        if (mStatus != PARSE_MORE) return mStatus;
+        while (1) {
+            action act = column >= 0 ? mTable.lookup(mStates.back(), column) : NA;
+            switch (act.type)
+            {
+            case SHIFT:
+                mStates.push_back(act.num);
+                mValues.push_back(std::move(value));
+                return settle();
+            case REDUCE:
+                if (!reduceBy(act.num) || settle() != PARSE_MORE) return mStatus = PARSE_ERROR;
+                break;
+            case ACCEPT:
+                return mStatus = PARSE_DONE;
+            default:
+                mEntry = column;
+                return mStatus = PARSE_ERROR;
+            }
+        }
+    }
+
+    /*
+     * Feeds the end marker once, the state it is shifted to must accept.
+     * The marker is only the last symbol of rule 0, a grammar may shift it
+     * elsewhere too, so feeding it until something changes need not end.
+     */
+    int finish() {
+        if (feed(mEnd, V()) != PARSE_MORE) return mStatus;
+        if (mTable.lookup(mStates.back(), mEnd).type == ACCEPT) return mStatus = PARSE_DONE;
+        mEntry = mEnd;
+        return mStatus = PARSE_ERROR;
+    }
+
+    int status() {
+        return mStatus;
+    }
+
+    //value of the start symbol after PARSE_DONE
+    V &result() {
+        return mValues[0];
+    }
+
+    int errorState() {
+        return mStates.back();
+    }
+
+    //column the parse failed on
+    int errorEntry() {
+        return mEntry;
+    }
+
+    //tokens and left sides on the stack
+    int depth() {
+        return mValues.size();
+    }
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include "lrgen.hpp"
+#include <deque>
+#include <algorithm>
+
+/*************************************************************
+ *                      SAVED AUTOMATON
+ *
+ * LRSTATE <version> <rules>
+ * <from> <size> <to>...                           one line per rule
+ * <states>
+ * <kernel> (<rule> <dot>)... <predicted> <id>... <gotos> (<id> <state>)...
+*************************************************************/
+#define LRSTATE_VERSION 1
+
+bool LRTable::save(const char *path) {
+    if (lr0.empty()) return false;
+    FILE *out = fopen(path, "w");
+    if (!out) return false;
+    fprintf(out, "LRSTATE %d %d\n", LRSTATE_VERSION, (int)rules.size());
+    for (int i = 0; i < rules.size(); i++) {
+        fprintf(out, "%d %d", symbols.id(rules[i]->getFrom()), rules[i]->getSize());
+        for (int j = 0; j < rules[i]->getSize(); j++) fprintf(out, " %d", symbols.id(rules[i]->getTo(j)));
+        fprintf(out, "\n");
+    }
+    fprintf(out, "%d\n", (int)lr0.size());
+    for (int i = 0; i < lr0.size(); i++) {
+        LR0State &state = lr0[i];
+        fprintf(out, "%d", (int)state.kernel.size());
+        for (int j = 0; j < state.kernel.size(); j++)
+            fprintf(out, " %d %d", state.kernel[j].first, state.kernel[j].second);
+        fprintf(out, " %d", (int)state.predicted.size());
+        for (int j = 0; j < state.predicted.size(); j++) fprintf(out, " %d", symbols.id(state.predicted[j]));
+        fprintf(out, " %d", (int)state.gotos.size());
+        for (auto it = state.gotos.begin(); it != state.gotos.end(); it++)
+            fprintf(out, " %d %d", symbols.id(it->first), it->second);
+        fprintf(out, "\n");
+    }
+    return fclose(out) == 0;
+}
+
+/*
+ * Reads the saved automaton with kernels renumbered to the current rules
+ * and ids turned into current symbols. changed gets the symbols whose
+ * rules differ, -1 standing for every id the grammar no longer has.
+ */
+static bool loadLR0(FILE *in, const Rules &rules, const SymbolTable &symbols, vector<LR0State> &states, set<int> &changed) {
+    int version, nrules;
+    if (fscanf(in, "LRSTATE %d %d", &version, &nrules) != 2 || version != LRSTATE_VERSION) return false;
+    //match old rules to current ones by content, duplicates in order
+    map<vector<int>, deque<int>> current;
+    for (int i = 0; i < rules.size(); i++) {
+        vector<int> key(1, symbols.id(rules[i]->getFrom()));
+        for (int j = 0; j < rules[i]->getSize(); j++) key.push_back(symbols.id(rules[i]->getTo(j)));
+        current[key].push_back(i);
+    }
+    vector<int> ruleMap(nrules, -1);
+    for (int i = 0; i < nrules; i++) {
+        int size;
+        vector<int> key(1);
+        if (fscanf(in, "%d %d", &key[0], &size) != 2 || size < 0) return false;
+        key.resize(size+1);
+        for (int j = 1; j <= size; j++) {
+            if (fscanf(in, "%d", &key[j]) != 1) return false;
+        }
+        auto found = current.find(key);
+        if (found == current.end() || found->second.empty()) {
+            changed.insert(symbols.symbol(key[0]));
+            continue;
+        }
+        ruleMap[i] = found->second.front();
+        found->second.pop_front();
+    }
+    for (auto it = current.begin(); it != current.end(); it++) {
+        if (!it->second.empty()) changed.insert(symbols.symbol(it->first[0]));
+    }
+    int nstates;
+    if (fscanf(in, "%d", &nstates) != 1 || nstates < 1) return false;
+    states.resize(nstates);
+    for (int i = 0; i < nstates; i++) {
+        int size, rule, dot, id, target;
+        bool broken = false;
+        if (fscanf(in, "%d", &size) != 1) return false;
+        for (int j = 0; j < size; j++) {
+            if (fscanf(in, "%d %d", &rule, &dot) != 2 || rule < 0 || rule >= nrules) return false;
+            if (ruleMap[rule] < 0) broken = true;
+            else states[i].kernel.push_back(LR0Item(ruleMap[rule], dot));
+        }
+        if (fscanf(in, "%d", &size) != 1) return false;
+        for (int j = 0; j < size; j++) {
+            if (fscanf(in, "%d", &id) != 1) return false;
+            states[i].predicted.push_back(symbols.symbol(id));
+        }
+        if (fscanf(in, "%d", &size) != 1) return false;
+        for (int j = 0; j < size; j++) {
+            if (fscanf(in, "%d %d", &id, &target) != 2 || target < 0 || target >= nstates) return false;
+            states[i].gotos[symbols.symbol(id)] = target;
+        }
+        //a kernel that lost a rule can no longer be reached
+        if (broken) states[i] = LR0State();
+        else sort(states[i].kernel.begin(), states[i].kernel.end());
+    }
+    return true;
+}
+
+/*
+ * Brings the saved automaton up to date with the current rules. A state
+ * is expanded again only when an item of its closure moves over a symbol
+ * whose productions changed; every other state keeps its kernel, gotos
+ * and number. States that became unreachable are retired and their numbers
+ * handed to new states.
+ */
+bool LRTable::updateLR0(const MappedRules &mapped, const ClosureTemplates &templates, const char *saved) {
+    FILE *in = fopen(saved, "r");
+    if (!in) return false;
+    set<int> changed;
+    bool ok = loadLR0(in, rules, symbols, lr0, changed);
+    fclose(in);
+    if (!ok || lr0[0].kernel != vector<LR0Item>(1, LR0Item(0, 0))) {
+        lr0.clear();
+        return false;
+    }
+    int oldCount = lr0.size();
+    KernelIndex index;
+    vector<int> numbers;    //kernel index -> state
+    vector<bool> dirty(oldCount, false);
+    for (int s = 0; s < oldCount; s++) {
+        if (lr0[s].kernel.empty()) continue;
+        if (index.insert(lr0[s].kernel) != numbers.size()) {
+            lr0.clear();
+            return false;
+        }
+        numbers.push_back(s);
+        //an item of the closure moves over a changed symbol, a predicted
+        //nonterminal or e.g. a terminal that gained rules
+        for (int i = 0; i < lr0[s].kernel.size(); i++) {
+            int next = rules[lr0[s].kernel[i].first]->getTo(lr0[s].kernel[i].second);
+            if (next >= 0 && changed.count(next)) dirty[s] = true;
+        }
+        for (int i = 0; i < lr0[s].predicted.size() && !dirty[s]; i++) {
+            int predicted = lr0[s].predicted[i];
+            if (changed.count(predicted)) {
+                dirty[s] = true;
+                break;
+            }
+            const vector<Rule *> &prods = mapped[predicted];
+            for (int j = 0; j < prods.size(); j++) {
+                if (prods[j]->getSize() > 0 && changed.count(prods[j]->getTo(0))) dirty[s] = true;
+            }
+        }
+        for (auto it = lr0[s].gotos.begin(); it != lr0[s].gotos.end(); it++) {
+            if (lr0[it->second].kernel.empty()) dirty[s] = true;
+        }
+    }
+    //walk from the start state, expanding only dirty and new states
+    vector<bool> reached(oldCount, false);
+    deque<int> next;
+    next.push_back(0);
+    reached[0] = true;
+    while (!next.empty()) {
+        int s = next.front();
+        next.pop_front();
+        if (!dirty[s]) {
+            lr0[s].items = lr0[s].kernel;
+            for (int i = 0; i < lr0[s].predicted.size(); i++) {
+                const vector<Rule *> &prods = mapped[lr0[s].predicted[i]];
+                for (int j = 0; j < prods.size(); j++) lr0[s].items.push_back(LR0Item(prods[j]->getIndex(), 0));
+            }
+        } else {
+            lr0[s].predicted.clear();
+            lr0[s].items = closeKernel(lr0[s].kernel, rules, templates, lr0[s].predicted);
+            lr0[s].gotos.clear();
+            vector<pair<int, vector<LR0Item>>> edges = gotoKernels(lr0[s].items, rules);
+            for (auto it = edges.begin(); it != edges.end(); it++) {
+                int id = index.insert(it->second);
+                if (id == numbers.size()) {
+                    numbers.push_back(lr0.size());
+                    LR0State state;
+                    state.kernel = it->second;
+                    lr0.push_back(state);
+                    dirty.push_back(true);
+                    reached.push_back(false);
+                }
+                lr0[s].gotos[it->first] = numbers[id];
+            }
+        }
+        for (auto it = lr0[s].gotos.begin(); it != lr0[s].gotos.end(); it++) {
+            if (reached[it->second]) continue;
+            reached[it->second] = true;
+            next.push_back(it->second);
+        }
+    }
+    //new states fill the numbers of retired ones, the rest move down behind them
+    vector<int> remap(lr0.size(), -1);
+    int hole = 0;
+    int count = oldCount;
+    for (int s = 0; s < oldCount; s++) {
+        if (reached[s]) remap[s] = s;
+    }
+    for (int s = oldCount; s < lr0.size(); s++) {
+        if (!reached[s]) continue;
+        while (hole < oldCount && reached[hole]) hole++;
+        remap[s] = hole < oldCount ? hole++ : count++;
+    }
+    vector<LR0State> states(count);
+    for (int s = 0; s < lr0.size(); s++) {
+        if (remap[s] < 0) continue;
+        for (auto it = lr0[s].gotos.begin(); it != lr0[s].gotos.end(); it++) {
+            it->second = remap[it->second];
+        }
+        states[remap[s]] = lr0[s];
+    }
+    while (states.back().kernel.empty()) states.pop_back();
+    lr0 = states;
+    return true;
+}
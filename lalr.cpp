@@ -0,0 +1,289 @@
+#include "lrgen.hpp"
+#include "workpool.hpp"
+#include <deque>
+#include <limits.h>
+#include <algorithm>
+#include <numeric>
+
+/***************************************************
+ *                  LR(0) AUTOMATON
+ **************************************************/
+static int symbolAt(const Rules &rules, LR0Item item) {
+    return rules[item.first]->getTo(item.second);
+}
+
+//kernel plus the rules of every template its items predict, each nonterminal once
+vector<LR0Item> closeKernel(const vector<LR0Item> &kernel, const Rules &rules, const ClosureTemplates &templates, vector<int> &predicted) {
+    vector<LR0Item> res = kernel;
+    set<int> seen;
+    for (int i = 0; i < kernel.size(); i++) {
+        const ClosureTemplate *t = templates.find(symbolAt(rules, kernel[i]));
+        if (!t || seen.count(t->predicted[0])) continue;
+        for (int j = 0; j < t->rules.size(); j++) {
+            int from = t->rules[j]->getFrom();
+            if (seen.count(from)) continue;
+            if (predicted.empty() || predicted.back() != from) predicted.push_back(from);
+            res.push_back(LR0Item(t->rules[j]->getIndex(), 0));
+        }
+        seen.insert(t->predicted.begin(), t->predicted.end());
+    }
+    return res;
+}
+
+//sorted kernel of every goto target of a closed item set, by symbol
+vector<pair<int, vector<LR0Item>>> gotoKernels(const vector<LR0Item> &items, const Rules &rules) {
+    vector<pair<int, LR0Item>> moves;
+    for (int i = 0; i < items.size(); i++) {
+        int sym = symbolAt(rules, items[i]);
+        if (sym >= 0) moves.push_back(pair<int, LR0Item>(sym, LR0Item(items[i].first, items[i].second+1)));
+    }
+    sort(moves.begin(), moves.end());
+    vector<pair<int, vector<LR0Item>>> res;
+    for (int i = 0; i < moves.size(); i++) {
+        if (i == 0 || moves[i].first != moves[i-1].first) res.push_back(pair<int, vector<LR0Item>>(moves[i].first, vector<LR0Item>()));
+        res.back().second.push_back(moves[i].second);
+    }
+    return res;
+}
+
+struct Expansion {
+    vector<LR0Item> items;
+    vector<int> predicted;
+    vector<pair<int, int>> edges;   //symbol, interned kernel id
+};
+
+/*
+ * Breadth first, one level at a time: the states of a level are closed
+ * and their goto kernels interned on the pool, then a serial pass numbers
+ * new kernels in state and symbol order. This is the numbering a plain
+ * bfs gives, whatever the number of threads. Interning and numbering are
+ * charged to the dedup phase.
+ */
+void LRTable::buildLR0(const ClosureTemplates &templates, int threads) {
+    WorkPool pool(threads);
+    ConcurrentKernelIndex index;
+    vector<int> numbers;    //interned kernel id -> state
+    LR0State start;
+    start.kernel.push_back(LR0Item(0, 0));
+    lr0.push_back(start);
+    numbers.resize(index.intern(start.kernel)+1, -1);
+    numbers.back() = 0;
+    vector<double> interning(pool.size());  //per worker, seconds this level
+    vector<double> busy(pool.size());
+    for (int begin = 0; begin < lr0.size(); ) {
+        int end = lr0.size();
+        vector<Expansion> level(end-begin);
+        fill(interning.begin(), interning.end(), 0);
+        fill(busy.begin(), busy.end(), 0);
+        double levelStart = wallSeconds();
+        pool.run(end-begin, [&](int i, int worker) {
+            double taskStart = wallSeconds();
+            Expansion &exp = level[i];
+            exp.items = closeKernel(lr0[begin+i].kernel, rules, templates, exp.predicted);
+            vector<pair<int, vector<LR0Item>>> edges = gotoKernels(exp.items, rules);
+            double internStart = wallSeconds();
+            for (auto it = edges.begin(); it != edges.end(); it++) {
+                exp.edges.push_back(pair<int, int>(it->first, index.intern(it->second)));
+            }
+            double done = wallSeconds();
+            interning[worker] += done - internStart;
+            busy[worker] += done - taskStart;
+        });
+        //the level's wall time is split between closing and interning as its tasks spent it
+        double levelTime = wallSeconds() - levelStart;
+        double interned = accumulate(interning.begin(), interning.end(), 0.0);
+        double worked = accumulate(busy.begin(), busy.end(), 0.0);
+        if (worked > 0) stats.seconds[PHASE_DEDUP] += levelTime * interned / worked;
+        double start = wallSeconds();
+        for (int i = 0; i < level.size(); i++) {
+            lr0[begin+i].items = level[i].items;
+            lr0[begin+i].predicted = level[i].predicted;
+            for (int j = 0; j < level[i].edges.size(); j++) {
+                int id = level[i].edges[j].second;
+                if (id >= numbers.size()) numbers.resize(id+1, -1);
+                if (numbers[id] < 0) {
+                    numbers[id] = lr0.size();
+                    LR0State next;
+                    next.kernel = index.kernel(id);
+                    lr0.push_back(next);
+                }
+                lr0[begin+i].gotos[level[i].edges[j].first] = numbers[id];
+            }
+        }
+        stats.seconds[PHASE_DEDUP] += wallSeconds() - start;
+        begin = end;
+    }
+}
+
+/***************************************************
+ *              DEREMER-PENNELLO DIGRAPH
+ **************************************************/
+BitSets::BitSets(int rows, int universe) : mWords((universe + 63) / 64), mBits((size_t)rows * mWords, 0) {
+}
+
+void BitSets::insert(int row, int value) {
+    mBits[(size_t)row * mWords + (value >> 6)] |= (uint64_t)1 << (value & 63);
+}
+
+void BitSets::unite(int row, int other) {
+    uint64_t *to = &mBits[(size_t)row * mWords];
+    const uint64_t *from = &mBits[(size_t)other * mWords];
+    for (int i = 0; i < mWords; i++) to[i] |= from[i];
+}
+
+void BitSets::clear(int row) {
+    uint64_t *bits = &mBits[(size_t)row * mWords];
+    for (int i = 0; i < mWords; i++) bits[i] = 0;
+}
+
+void BitSets::assign(int row, int other) {
+    uint64_t *to = &mBits[(size_t)row * mWords];
+    const uint64_t *from = &mBits[(size_t)other * mWords];
+    for (int i = 0; i < mWords; i++) to[i] = from[i];
+}
+
+//members of row, ascending
+vector<int> BitSets::values(int row) const {
+    vector<int> res;
+    const uint64_t *bits = &mBits[(size_t)row * mWords];
+    for (int i = 0; i < mWords; i++) {
+        for (uint64_t w = bits[i]; w; w &= w - 1) res.push_back(i * 64 + __builtin_ctzll(w));
+    }
+    return res;
+}
+
+/*
+ * One strongly connected component at a time, every member ends up with
+ * the union over the component. The depth first walk keeps its own frame
+ * stack, so long chains of the relation cannot overflow the call stack.
+ */
+struct DigraphFrame {
+    int node;
+    int edge;       //next relation edge to follow
+    int depth;      //stack height when the node was entered
+};
+
+void digraph(const vector<vector<int>> &relation, BitSets &sets) {
+    vector<int> stack;
+    vector<int> depth(relation.size(), 0);
+    vector<DigraphFrame> frames;
+    for (int root = 0; root < relation.size(); root++) {
+        if (depth[root] != 0) continue;
+        stack.push_back(root);
+        depth[root] = stack.size();
+        frames.push_back(DigraphFrame{root, 0, (int)stack.size()});
+        while (!frames.empty()) {
+            DigraphFrame &frame = frames.back();
+            int x = frame.node;
+            if (frame.edge < relation[x].size()) {
+                int y = relation[x][frame.edge];
+                if (depth[y] == 0) {
+                    //the edge is taken again once y is done
+                    stack.push_back(y);
+                    depth[y] = stack.size();
+                    frames.push_back(DigraphFrame{y, 0, (int)stack.size()});
+                    continue;
+                }
+                if (depth[y] < depth[x]) depth[x] = depth[y];
+                sets.unite(x, y);
+                frame.edge++;
+                continue;
+            }
+            int d = frame.depth;
+            frames.pop_back();
+            if (depth[x] != d) continue;
+            while (1) {
+                int top = stack.back();
+                stack.pop_back();
+                depth[top] = INT_MAX;
+                if (top == x) break;
+                sets.assign(top, x);
+            }
+        }
+    }
+}
+
+/***************************************************
+ *                      LALR(1)
+ **************************************************/
+//goto of state on sym, a missing one is a broken automaton
+static int gotoOf(const LR0State &state, int sym) {
+    auto it = state.gotos.find(sym);
+    if (it == state.gotos.end()) panic("lookaheads: missing goto");
+    return it->second;
+}
+
+int LRTable::lookaheads(MappedRules &mapped, FirstSets &firsts, vector<Link> &links) {
+    //nonterminal transitions (p, A)
+    map<pair<int, int>, int> transIndex;
+    vector<pair<int, int>> trans;
+    for (int s = 0; s < lr0.size(); s++) {
+        for (auto it = lr0[s].gotos.begin(); it != lr0[s].gotos.end(); it++) {
+            if (symbols.isTerminal(it->first)) continue;
+            transIndex[pair<int, int>(s, it->first)] = trans.size();
+            trans.push_back(pair<int, int>(s, it->first));
+        }
+    }
+    int scratch = trans.size();     //row for the lookaheads of one item
+    BitSets sets(trans.size()+1, symbols.terminals());
+    vector<vector<int>> reads(trans.size());
+    vector<vector<int>> includes(trans.size());
+    map<LR0Item, vector<int>> lookback;     //(state, rule) -> transitions
+    //DR(p, A) = terminals shifted out of goto(p, A), reads through nullable nonterminals
+    for (int x = 0; x < trans.size(); x++) {
+        int to = gotoOf(lr0[trans[x].first], trans[x].second);
+        for (auto it = lr0[to].gotos.begin(); it != lr0[to].gotos.end(); it++) {
+            if (symbols.isTerminal(it->first)) sets.insert(x, it->first);
+            else if (firsts.isNullable(it->first))
+                reads[x].push_back(transIndex[pair<int, int>(to, it->first)]);
+        }
+    }
+    digraph(reads, sets);
+    //(p', B) includes (p, A) when B -> b A c with c nullable, lookback for completed items
+    for (int x = 0; x < trans.size(); x++) {
+        vector<Rule *> &prods = mapped[trans[x].second];
+        for (int i = 0; i < prods.size(); i++) {
+            int state = trans[x].first;
+            for (int j = 0; j < prods[i]->getSize(); j++) {
+                int sym = prods[i]->getTo(j);
+                int next = gotoOf(lr0[state], sym);
+                if (!symbols.isTerminal(sym)) {
+                    int k = j+1;
+                    while (k < prods[i]->getSize() && firsts.isNullable(prods[i]->getTo(k))) k++;
+                    if (k == prods[i]->getSize())
+                        includes[transIndex[pair<int, int>(state, sym)]].push_back(x);
+                }
+                state = next;
+            }
+            lookback[LR0Item(state, prods[i]->getIndex())].push_back(x);
+        }
+    }
+    digraph(includes, sets);
+    //emit links in the same order as buildMerged: shifts and gotos, reduces, accept
+    for (int s = 0; s < lr0.size(); s++) {
+        if (lr0[s].kernel.empty()) continue;
+        bool isEnd = lr0[s].gotos.empty();
+        for (auto it = lr0[s].gotos.begin(); it != lr0[s].gotos.end(); it++) {
+            links.push_back(makeLink(s, it->second, symbols.isTerminal(it->first) ? SHIFT : GOTO, it->first));
+        }
+        for (int i = 0; i < lr0[s].items.size(); i++) {
+            LR0Item item = lr0[s].items[i];
+            if (symbolAt(rules, item) >= 0) continue;
+            auto from = lookback.find(LR0Item(s, item.first));
+            if (from == lookback.end()) continue;
+            sets.clear(scratch);
+            for (int j = 0; j < from->second.size(); j++) sets.unite(scratch, from->second[j]);
+            vector<int> row = sets.values(scratch);
+            for (int k = 0; k < row.size(); k++) {
+                isEnd = false;
+                links.push_back(makeLink(s, item.first, REDUCE, row[k]));
+            }
+        }
+        if (isEnd) {
+            for (int symbol = 0; symbol < symbols.size(); symbol++) {
+                links.push_back(makeLink(s, 0, ACCEPT, symbol));
+            }
+        }
+    }
+    return lr0.size();
+}
@@ -1,5 +1,57 @@
 #include "lrgen.hpp"
+#include "packedtable.hpp"
 #include <deque>
+#include <algorithm>
+#include <chrono>
+#include <malloc.h>
+#include <limits.h>
+#include <iterator>
+
+/***************************************************
+ *                      SYMBOLS
+ **************************************************/
+SymbolTable::SymbolTable() : mTerminals(0) {}
+
+SymbolTable::SymbolTable(File *file) {
+    vector<int> all;
+    vector<int> lefts;
+    for (File *i = file; i; i = i->next) {
+        lefts.push_back(id2int(i->line->id));
+        all.push_back(lefts.back());
+        for (Exp *exp = i->line->exp; exp; exp = exp->next) all.push_back(id2int(exp->id));
+    }
+    sort(all.begin(), all.end());
+    all.erase(unique(all.begin(), all.end()), all.end());
+    sort(lefts.begin(), lefts.end());
+    lefts.erase(unique(lefts.begin(), lefts.end()), lefts.end());
+    set_difference(all.begin(), all.end(), lefts.begin(), lefts.end(), back_inserter(mIds));
+    mTerminals = mIds.size();
+    mIds.insert(mIds.end(), lefts.begin(), lefts.end());
+    for (int i = 0; i < mIds.size(); i++) mSymbols.push_back(pair<int, int>(mIds[i], i));
+    sort(mSymbols.begin(), mSymbols.end());
+}
+
+//symbol of a grammar id, -1 when the grammar does not use it
+int SymbolTable::symbol(int id) const {
+    auto it = lower_bound(mSymbols.begin(), mSymbols.end(), pair<int, int>(id, INT_MIN));
+    return it != mSymbols.end() && it->first == id ? it->second : -1;
+}
+
+int SymbolTable::id(int symbol) const {
+    return mIds[symbol];
+}
+
+int SymbolTable::size() const {
+    return mIds.size();
+}
+
+int SymbolTable::terminals() const {
+    return mTerminals;
+}
+
+bool SymbolTable::isTerminal(int symbol) const {
+    return symbol < mTerminals;
+}
 
 /***************************************************
  *                      RULE
@@ -12,6 +64,14 @@ Rule::Rule(Line *line, int index) {
     }
 }
 
+Rule::Rule(Line *line, int index, const SymbolTable &symbols) {
+    this->mIndex = index;
+    this->mFrom = symbols.symbol(id2int(line->id));
+    for (Exp *exp = line->exp; exp; exp = exp->next) {
+        this->mTo.push_back(symbols.symbol(id2int(exp->id)));
+    }
+}
+
 int Rule::getIndex() {
     return this->mIndex;
 }
@@ -29,39 +89,159 @@ int Rule::getSize() {
     return mTo.size();
 }
 
-MappedRules mapRules(const Rules &rules) {
-    MappedRules res;
+MappedRules mapRules(const Rules &rules, int symbols) {
+    MappedRules res(symbols);
     for (int i = 0; i < rules.size(); i++)
         res[rules[i]->getFrom()].push_back(rules[i]);
     return res;
 }
 
-set<int> first(int id, MappedRules &rules) {
-    set<int> res;
-    set<int> visited;
-    deque<int> next;
-    next.push_back(id);
-    visited.insert(id);
-    while(!next.empty()) {
-        int node = next.front();
-        next.pop_front();
-        if (rules[node].empty()) {
-            res.insert(node);
-            continue;
+/********************************************************
+ *                      FIRST
+********************************************************/
+/*
+ * Nullable by counting down, per rule, the right side symbols not yet
+ * known nullable; each symbol found nullable visits the rules using it
+ * once. FIRST is then the digraph of "A -> a X b with a nullable", a
+ * terminal starts out as its own FIRST.
+ */
+FirstSets::FirstSets(MappedRules &rules) : mFirst(rules.size()), mNullable(rules.size(), false) {
+    int symbols = rules.size();
+    vector<vector<Rule *>> uses(symbols);   //symbol -> rules with it on the right, once per use
+    vector<int> pending;                    //rule index -> right side symbols not known nullable
+    vector<int> work;
+    for (int id = 0; id < symbols; id++) {
+        for (int i = 0; i < rules[id].size(); i++) {
+            Rule *rule = rules[id][i];
+            if (rule->getIndex() >= pending.size()) pending.resize(rule->getIndex()+1);
+            pending[rule->getIndex()] = rule->getSize();
+            for (int j = 0; j < rule->getSize(); j++) uses[rule->getTo(j)].push_back(rule);
+            if (rule->getSize() == 0 && !mNullable[id]) {
+                mNullable[id] = true;
+                work.push_back(id);
+            }
         }
-        for (int i = 0; i < rules[node].size(); i++) {
-            if (!visited.count(rules[node][i]->getTo(0)))
-                next.push_back(rules[node][i]->getTo(0));
+    }
+    while (!work.empty()) {
+        int id = work.back();
+        work.pop_back();
+        for (int i = 0; i < uses[id].size(); i++) {
+            Rule *rule = uses[id][i];
+            if (--pending[rule->getIndex()] > 0 || mNullable[rule->getFrom()]) continue;
+            mNullable[rule->getFrom()] = true;
+            work.push_back(rule->getFrom());
         }
     }
+    vector<vector<int>> starts(symbols);
+    BitSets sets(symbols, symbols);
+    for (int id = 0; id < symbols; id++) {
+        if (rules[id].empty()) sets.insert(id, id);
+        for (int i = 0; i < rules[id].size(); i++) {
+            Rule *rule = rules[id][i];
+            for (int j = 0; j < rule->getSize(); j++) {
+                starts[id].push_back(rule->getTo(j));
+                if (!mNullable[rule->getTo(j)]) break;
+            }
+        }
+    }
+    digraph(starts, sets);
+    for (int id = 0; id < symbols; id++) {
+        vector<int> first = sets.values(id);
+        mFirst[id].insert(first.begin(), first.end());
+    }
+}
+
+const set<int> &FirstSets::first(int id) {
+    return mFirst[id];
+}
+
+bool FirstSets::isNullable(int id) {
+    return mNullable[id];
+}
+
+//FIRST of rule's right side from index on, followed by endings
+set<int> FirstSets::firstOf(Rule *rule, int index, const set<int> &endings) {
+    set<int> res;
+    for (int i = index; i < rule->getSize(); i++) {
+        const set<int> &s = first(rule->getTo(i));
+        res.insert(s.begin(), s.end());
+        if (!isNullable(rule->getTo(i))) return res;
+    }
+    res.insert(endings.begin(), endings.end());
     return res;
 }
 
+/********************************************************
+ *                  CLOSURE TEMPLATES
+********************************************************/
+static bool restNullable(FirstSets &firsts, Rule *rule, int index) {
+    for (int i = index; i < rule->getSize(); i++) {
+        if (!firsts.isNullable(rule->getTo(i))) return false;
+    }
+    return true;
+}
+
+/*
+ * For each root, a fixed point over the nonterminals it reaches: C -> D x
+ * gives D the FIRST of x, and when x is nullable also whatever C gets,
+ * including the root's lookahead.
+ */
+ClosureTemplates::ClosureTemplates(MappedRules &rules, FirstSets &firsts) : mTemplates(rules.size()) {
+    for (int root = 0; root < rules.size(); root++) {
+        if (rules[root].empty()) continue;
+        vector<int> order(1, root);
+        map<int, set<int>> spontaneous;
+        set<int> propagated;
+        propagated.insert(root);
+        deque<int> work(1, root);
+        while (!work.empty()) {
+            int node = work.front();
+            work.pop_front();
+            vector<Rule *> &prods = rules[node];
+            for (int i = 0; i < prods.size(); i++) {
+                int next = prods[i]->getTo(0);
+                if (rules[next].empty()) continue;
+                bool isNew = !spontaneous.count(next) && !propagated.count(next) && next != root;
+                set<int> &ends = spontaneous[next];
+                int size = ends.size();
+                set<int> first = firsts.firstOf(prods[i], 1, set<int>());
+                ends.insert(first.begin(), first.end());
+                bool grew = false;
+                if (restNullable(firsts, prods[i], 1)) {
+                    const set<int> &inherited = spontaneous[node];
+                    ends.insert(inherited.begin(), inherited.end());
+                    if (propagated.count(node) && !propagated.count(next)) {
+                        propagated.insert(next);
+                        grew = true;
+                    }
+                }
+                if (isNew) order.push_back(next);
+                if (isNew || grew || ends.size() != size) work.push_back(next);
+            }
+        }
+        ClosureTemplate &res = mTemplates[root];
+        res.predicted = order;
+        for (int i = 0; i < order.size(); i++) {
+            vector<Rule *> &prods = rules[order[i]];
+            for (int j = 0; j < prods.size(); j++) {
+                res.rules.push_back(prods[j]);
+                res.spontaneous.push_back(spontaneous[order[i]]);
+                res.propagated.push_back(propagated.count(order[i]));
+            }
+        }
+    }
+}
+
+//template of a nonterminal, NULL for terminals and the -1 past a rule's end
+const ClosureTemplate *ClosureTemplates::find(int id) const {
+    if (id < 0 || mTemplates[id].rules.empty()) return NULL;
+    return &mTemplates[id];
+}
 
 /********************************************************
  *                      ITEM
 ********************************************************/
-Item::Item(Rule *rule, int index, set<int> endings) {
+Item::Item(Rule *rule, int index, const set<int> &endings) {
     this->mRule = rule;
     this->mIndex = index;
     this->mEndings = endings;
@@ -72,15 +252,16 @@ int Item::next() {
 int Item::doubleNext() {
     return this->mRule->getTo(mIndex+1);
 }
-Item * Item::advance() {
-    return new Item(this->mRule, this->mIndex+1, this->mEndings);
+Item * Item::advance(Pool<Item> &pool) {
+    return pool.make(this->mRule, this->mIndex+1, this->mEndings);
 }
-void Item::unionEnding(set<int> endings) {
-    for (auto it = endings.begin(); it != endings.end(); it++) {
-        this->mEndings.insert(*it);
-    }
+int Item::getPosition() {
+    return this->mIndex;
+}
+void Item::unionEnding(const set<int> &endings) {
+    mEndings.insert(endings.begin(), endings.end());
 }
-set<int> Item::getEndings() {
+const set<int> &Item::getEndings() {
     return mEndings;
 }
 bool Item::compare(Item *item) {
@@ -89,6 +270,7 @@ bool Item::compare(Item *item) {
     if (item->mRule->getSize() > this->mRule->getSize()) return true;
     if (item->mRule->getSize() < this->mRule->getSize()) return false;
     if (item->mIndex > this->mIndex) return true;
+    if (item->mIndex < this->mIndex) return false;
     for (int i = 0; i < this->mRule->getSize(); i++) {
         if (item->mRule->getTo(i) > this->mRule->getTo(i)) return true;
         if (item->mRule->getTo(i) < this->mRule->getTo(i)) return false;
@@ -104,11 +286,10 @@ Rule * Item::getRule() {
     return mRule;
 }
 
-void printItems(set<Item *, decltype(itemcmp)*> items, const set<int> &ids, const set<int> &complexIds) {
+void printItems(const set<Item *, decltype(itemcmp)*> &items, const SymbolTable &symbols) {
     map<int, char> dict;
-    int i = 0;
-    for (auto it = ids.begin(); it != ids.end(); it++) {
-        dict[*it] = (complexIds.count(*it) ? 'A' : 'a') + i++;
+    for (int i = 0; i < symbols.size(); i++) {
+        dict[i] = (symbols.isTerminal(i) ? 'a' : 'A') + i;
     }
     dict[-1] = '$';
     dict[11] = 'S';
@@ -120,7 +301,7 @@ void printItems(set<Item *, decltype(itemcmp)*> items, const set<int> &ids, cons
             printf("/%c", dict[to]);
         }
         printf(" at: %c     ", dict[(*it)->next()]);
-        auto endings = (*it)->getEndings();
+        const set<int> &endings = (*it)->getEndings();
         for (auto end = endings.begin(); end != endings.end(); end++) {
             printf("/%c", dict[*end]);
         }
@@ -131,30 +312,39 @@ void printItems(set<Item *, decltype(itemcmp)*> items, const set<int> &ids, cons
  *                      Closure
 *****************************************************/
 
-Closure::Closure(MappedRules &rules, set<Item *> items, int state) {
+/*
+ * Kernel items predict through the templates, so the closure is a union of
+ * templates. Only a kernel item still at position 0 can gain endings from
+ * a template, those are predicted again until nothing changes.
+ */
+Closure::Closure(const ClosureTemplates &templates, FirstSets &firsts, Pool<Item> &pool, const vector<Item *> &items, int state) {
     mState = state;
-    deque<Item *> temp;
     set<Item *, decltype(itemcmp)*> newSet(itemcmp);
     this->mItems = newSet;
     for (auto i = items.begin(); i != items.end(); i++) {
         this->mItems.insert(*i);
-        temp.push_back(*i);
-    }
-    while (!temp.empty()) {
-        Item *item = temp.front();
-        temp.pop_front();
-        int node;
-        if ((node = item->next()) < 0) continue;
-        set<int> endings = item->doubleNext() < 0 ? item->getEndings() : first(item->doubleNext(), rules);
-        for (int i = 0; i < rules[node].size(); i++) {
-            Item *newItem = new Item(rules[node][i], 0, endings);
-            if (this->mItems.count(newItem)) {
-                auto item = *(this->mItems.find(newItem));
-                item->unionEnding(endings);
-                continue;
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto i = items.begin(); i != items.end(); i++) {
+            const ClosureTemplate *t = templates.find((*i)->next());
+            if (!t) continue;
+            set<int> context = firsts.firstOf((*i)->getRule(), (*i)->getPosition()+1, (*i)->getEndings());
+            for (int k = 0; k < t->rules.size(); k++) {
+                Item probe(t->rules[k], 0, set<int>());
+                auto found = this->mItems.find(&probe);
+                if (found == this->mItems.end()) {
+                    Item *item = pool.make(t->rules[k], 0, t->spontaneous[k]);
+                    if (t->propagated[k]) item->unionEnding(context);
+                    this->mItems.insert(item);
+                    continue;
+                }
+                int size = (*found)->getEndings().size();
+                (*found)->unionEnding(t->spontaneous[k]);
+                if (t->propagated[k]) (*found)->unionEnding(context);
+                if ((*found)->getEndings().size() != size && std::find(items.begin(), items.end(), *found) != items.end()) changed = true;
             }
-            temp.push_back(newItem);
-            this->mItems.insert(newItem);
         }
     }
 }
@@ -189,18 +379,33 @@ void printItem(Item *item) {
     printf("\n");
 }
 
-map<int, set<Item *>> Closure::advanceItems() {
-    map<int, set<Item *>> res;
+/*
+ * Shifts and reductions are collected as they come, in item order, then
+ * stably sorted by symbol. Every reduction is kept, conflicts between
+ * them are settled and counted by createTable.
+ */
+Edges Closure::advanceItems(Pool<Item> &pool) {
+    Edges res;
+    vector<pair<int, Item *>> shifts;
     for(auto it = this->mItems.begin(); it != this->mItems.end(); it++) {
-        if ((*it)->next() >= 0) res[(*it)->next()].insert((*it)->advance());
+        if ((*it)->next() >= 0) shifts.push_back(pair<int, Item *>((*it)->next(), (*it)->advance(pool)));
         else {
-            auto endings = (*it)->getEndings();
-            for (auto end = endings.begin(); 
-                end != endings.end(); end++) {
-                res[-(*end)-1].insert(*it);
+            const set<int> &endings = (*it)->getEndings();
+            for (auto end = endings.begin(); end != endings.end(); end++) {
+                res.reduces.push_back(Reduction{*end, *it});
             }
         }
     }
+    stable_sort(shifts.begin(), shifts.end(), [](const pair<int, Item *> &a, const pair<int, Item *> &b) {
+        return a.first < b.first;
+    });
+    for (int i = 0; i < shifts.size(); i++) {
+        if (i == 0 || shifts[i].first != shifts[i-1].first) res.shifts.push_back(Transition{shifts[i].first, vector<Item *>()});
+        res.shifts.back().items.push_back(shifts[i].second);
+    }
+    stable_sort(res.reduces.begin(), res.reduces.end(), [](const Reduction &a, const Reduction &b) {
+        return a.ending < b.ending;
+    });
     return res;
 }
 
@@ -209,22 +414,25 @@ void Closure::combineEndings(Closure *closure) {
         printf("ERROR");
         return;
     }
-    auto titems = this->mItems;
-    auto citems = closure->mItems;
-    auto thisit = titems.begin();
-    auto closit = citems.begin();
-    while (thisit != titems.end()) {
+    auto thisit = this->mItems.begin();
+    auto closit = closure->mItems.begin();
+    while (thisit != this->mItems.end()) {
         (*thisit)->unionEnding((*closit)->getEndings());
         thisit++;
         closit++;
     }
 }
 
+Item *Closure::find(Item *item) {
+    auto it = this->mItems.find(item);
+    return it == this->mItems.end() ? NULL : *it;
+}
+
 int Closure::getState() {
     return mState;
 }
 
-set<Item *, decltype(itemcmp)*> Closure::getItems() {
+const set<Item *, decltype(itemcmp)*> &Closure::getItems() {
     return mItems;
 }
 
@@ -233,74 +441,165 @@ bool closurecmp(Closure * const &a, Closure * const &b) {
     return res;
 }
 /*************************************************************
- *                          LRTable
+ *                      KernelIndex
 *************************************************************/
-Rules file2Rules(File *file) {
-    Rules res;
-    for (File *i = file; i; i = i->next) {
-        res.push_back(new Rule(i->line, res.size()));
+vector<LR0Item> kernelOf(const vector<Item *> &items) {
+    vector<LR0Item> res;
+    for (auto it = items.begin(); it != items.end(); it++) {
+        res.push_back(LR0Item((*it)->getRule()->getIndex(), (*it)->getPosition()));
     }
+    sort(res.begin(), res.end());
     return res;
 }
 
-set<int> getEOFEnding() {
-    set<int> res;
-    // res.insert(EOF);
-    return res;
+uint64_t hashKernel(const vector<LR0Item> &kernel) {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < kernel.size(); i++) {
+        h ^= ((uint64_t)kernel[i].first << 32) | (uint32_t)kernel[i].second;
+        h *= 0x100000001b3ULL;
+        h ^= h >> 29;
+    }
+    return h;
 }
 
-set<int> allIdsFromExp(Exp *exp) {
-    set<int> ids;
-    if (!exp) return ids;
-    ids.insert(id2int(exp->id));
-    auto s = allIdsFromExp(exp->next);
-    for (auto it = s.begin(); it != s.end(); it++) {
-        ids.insert(*it);
+KernelIndex::KernelIndex() : mHashes(64), mSlots(64, -1) {}
+
+//slot holding kernel, or the empty slot where it belongs
+int KernelIndex::probe(const vector<LR0Item> &kernel, uint64_t hash) {
+    int mask = mSlots.size()-1;
+    for (int i = hash & mask; ; i = (i+1) & mask) {
+        if (mSlots[i] < 0) return i;
+        if (mHashes[i] == hash && mKernels[mSlots[i]] == kernel) return i;
     }
-    return ids;
 }
 
-set<int> allIdsFromLine(Line *line) {
-    set<int> ids;
-    ids.insert(id2int(line->id));
-    auto s = allIdsFromExp(line->exp);
-    for (auto it = s.begin(); it != s.end(); it++) {
-        ids.insert(*it);
+void KernelIndex::grow() {
+    vector<uint64_t> hashes = mHashes;
+    vector<int> slots = mSlots;
+    mHashes.assign(hashes.size()*2, 0);
+    mSlots.assign(slots.size()*2, -1);
+    int mask = mSlots.size()-1;
+    for (int i = 0; i < slots.size(); i++) {
+        if (slots[i] < 0) continue;
+        int j = hashes[i] & mask;
+        while (mSlots[j] >= 0) j = (j+1) & mask;
+        mHashes[j] = hashes[i];
+        mSlots[j] = slots[i];
     }
-    return ids;
 }
 
-set<int> allIdsFromFile(File *file) {
-    if (!file) return set<int>();
-    set<int> ids = allIdsFromLine(file->line);
-    set<int> s = allIdsFromFile(file->next);
-    for (auto it = s.begin(); it != s.end(); it++) {
-        ids.insert(*it);
+int KernelIndex::find(const vector<LR0Item> &kernel) {
+    return mSlots[probe(kernel, hashKernel(kernel))];
+}
+
+//returns the state number of kernel, numbering it if it is new
+int KernelIndex::insert(const vector<LR0Item> &kernel) {
+    return insert(kernel, hashKernel(kernel));
+}
+
+int KernelIndex::insert(const vector<LR0Item> &kernel, uint64_t hash) {
+    if (2*(mKernels.size()+1) > mSlots.size()) grow();
+    int slot = probe(kernel, hash);
+    if (mSlots[slot] >= 0) return mSlots[slot];
+    mHashes[slot] = hash;
+    mSlots[slot] = mKernels.size();
+    mKernels.push_back(kernel);
+    return mSlots[slot];
+}
+
+int KernelIndex::size() {
+    return mKernels.size();
+}
+
+const vector<LR0Item> &KernelIndex::kernel(int state) {
+    return mKernels[state];
+}
+
+int ConcurrentKernelIndex::intern(const vector<LR0Item> &kernel) {
+    uint64_t hash = hashKernel(kernel);
+    int shard = hash >> (64-KERNEL_SHARD_BITS);
+    lock_guard<mutex> guard(mLocks[shard]);
+    return mShards[shard].insert(kernel, hash) << KERNEL_SHARD_BITS | shard;
+}
+
+//only valid once no thread is interning any more
+const vector<LR0Item> &ConcurrentKernelIndex::kernel(int id) {
+    return mShards[id & ((1 << KERNEL_SHARD_BITS)-1)].kernel(id >> KERNEL_SHARD_BITS);
+}
+
+/*************************************************************
+ *                          STATS
+*************************************************************/
+const char *phaseName(int phase) {
+    static const char *names[PHASE_COUNT] = {
+        "load", "first", "closure", "dedup", "lookahead", "table"
+    };
+    return phase >= 0 && phase < PHASE_COUNT ? names[phase] : "?";
+}
+
+double wallSeconds() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//bytes handed out by malloc, over all arenas
+long heapInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+//charges the wall time and heap growth since the last mark to a phase
+class PhaseMark {
+private:
+    TableStats &mStats;
+    double mTime;
+    long mHeap;
+public:
+    PhaseMark(TableStats &stats) : mStats(stats), mTime(wallSeconds()), mHeap(heapInUse()) {}
+    void charge(int phase) {
+        double time = wallSeconds();
+        long heap = heapInUse();
+        mStats.seconds[phase] += time - mTime;
+        mStats.bytes[phase] += heap - mHeap;
+        mTime = time;
+        mHeap = heap;
+    }
+};
+
+/*************************************************************
+ *                          LRTable
+*************************************************************/
+Rules file2Rules(File *file) {
+    Rules res;
+    for (File *i = file; i; i = i->next) {
+        res.push_back(new Rule(i->line, res.size()));
     }
-    return ids;
+    return res;
 }
 
-set<int> complexIdsFromFile(File *file) {
-    if (!file) return set<int>();
-    set<int> ids;
-    ids.insert(id2int(file->line->id));
-    set<int> s = complexIdsFromFile(file->next);
-    for (auto it = s.begin(); it != s.end(); it++) {
-        ids.insert(*it);
+Rules file2Rules(File *file, Pool<Rule> &pool, const SymbolTable &symbols) {
+    Rules res;
+    for (File *i = file; i; i = i->next) {
+        res.push_back(pool.make(i->line, res.size(), symbols));
     }
-    return ids;
+    return res;
+}
+
+set<int> getEOFEnding() {
+    set<int> res;
+    // res.insert(EOF);
+    return res;
 }
 
-Link makeLink(int from, int to, int action, int id) {
+Link makeLink(int from, int to, int action, int symbol) {
     Link res;
     res.fromState = from;
     res.num = to;
     res.action = action;
-    res.id = id;
+    res.symbol = symbol;
     return res;
 }
 
-void printRules(Rules rules) {
+void printRules(const Rules &rules) {
     for (int i = 0; i < rules.size(); i++) {
         printf("/%d --> ", rules[i]->getFrom());
         int to;
@@ -311,131 +610,234 @@ void printRules(Rules rules) {
     }
 }
 
-vector<vector<action>> createTable(const vector<Link> &links, const Rules &rules, const set<int> &ids, const set<int> &complexIds, int states, map<int, int> &dict) {
-    vector<int> cols(ids.size());
-    auto it = ids.begin();
-    int offset = ids.size()-complexIds.size();
-    int k = 0;
-    for (int i = 0; i < cols.size(); i++) {
-        if (complexIds.count(*it)) {
-            dict[*it] = offset+k;
-            cols[offset+k++] = *it;
-        } else {
-            dict[*it] = i-k;
-            cols[i-k] = *it;
-        }
-        it++;
-    }
-    vector<vector<action>> res(states, vector<action>(ids.size(), NA));
+/*
+ * Symbols are the columns, terminals first. Both builders resolve
+ * conflicts here, in the same way: a reduction wins over a shift and the
+ * lowest rule index wins among reductions. Stats count the entries with
+ * a conflict of either kind, once each however often a state is emitted.
+ */
+static vector<vector<action>> createTable(const vector<Link> &links, const SymbolTable &symbols, int states,
+    vector<int> &defaults, TableStats &stats) {
+    int offset = symbols.terminals();
+    vector<vector<action>> res(states, vector<action>(symbols.size(), NA));
+    map<pair<int, int>, int> conflicts;     //(state, symbol) -> 1 shift/reduce | 2 reduce/reduce
     for (int i = 0; i < links.size(); i++) {
-        res[links[i].fromState][dict[links[i].id]] = createAction(links[i].action, links[i].num);
+        action &cell = res[links[i].fromState][links[i].symbol];
+        action act = createAction(links[i].action, links[i].num);
+        int kind = 0;
+        if (cell.type == REDUCE && act.type == REDUCE && cell.num != act.num) kind = 2;
+        else if (cell.type == SHIFT && act.type == REDUCE) kind = 1;
+        else if (cell.type == REDUCE && act.type == SHIFT) kind = 1;
+        if (kind) conflicts[pair<int, int>(links[i].fromState, links[i].symbol)] |= kind;
+        if (cell.type == REDUCE && (act.type == SHIFT || (act.type == REDUCE && cell.num < act.num))) continue;
+        cell = act;
+    }
+    for (auto it = conflicts.begin(); it != conflicts.end(); it++) {
+        if (it->second & 1) stats.shiftReduce++;
+        if (it->second & 2) stats.reduceReduce++;
+    }
+    //consistent states reduce by default, their reduce entries are redundant
+    defaults.assign(states, -1);
+    for (int s = 0; s < states; s++) {
+        defaults[s] = consistentReduction(res[s], offset);
+        if (defaults[s] < 0) continue;
+        for (int i = 0; i < offset; i++) res[s][i] = NA;
     }
     return res;
 }
 
-void printStates(vector<Closure *> states, const set<int> &ids, const set<int> &complexIds) {
+void printStates(const vector<Closure *> &states, const SymbolTable &symbols) {
     for (int i = 0; i < states.size(); i++) {
         printf("STATE %d\n", states[i]->getState());
         if (states[i]->getState() == 2) {
-            auto items = states[i]->advanceItems();
-            if (!items[1].empty()) {
-                printf("ERROR!\n");
+            Pool<Item> pool;
+            Edges edges = states[i]->advanceItems(pool);
+            for (int j = 0; j < edges.shifts.size(); j++) {
+                if (edges.shifts[j].symbol == 1) printf("ERROR!\n");
             }
         }
-        printItems(states[i]->getItems(), ids, complexIds);
+        printItems(states[i]->getItems(), symbols);
     }
 }
 
 bool isEndingEqual(Closure *c1, Closure *c2) {
-    auto items1 = c1->getItems();
-    auto items2 = c2->getItems();
+    const auto &items1 = c1->getItems();
+    const auto &items2 = c2->getItems();
     auto it1 = items1.begin();
     auto it2 = items2.begin();
     while (it1 != items1.end()) {
-        auto endings1 = (*it1)->getEndings();
-        auto endings2 = (*it2)->getEndings();
-        if (endings1.size() != endings2.size()) {
-            return false;
-        }
-        auto end1 = endings1.begin();
-        auto end2 = endings2.begin();
-        while(end1 != endings1.end()) {
-            if (*end1 != *end2) return false;
-            end1++;
-            end2++;
-        }
+        if ((*it1)->getEndings() != (*it2)->getEndings()) return false;
         it1++;
         it2++;
     }
     return true;
 }
 
-LRTable::LRTable(File *file) {
+LRTable::LRTable(File *file, int mode, int threads) {
+    init(file, mode, threads, NULL);
+}
+
+//LALR table that reuses the automaton saved by a previous run where it can
+LRTable::LRTable(File *file, const char *saved, int threads) {
+    init(file, BUILD_LALR, threads, saved);
+}
+
+void LRTable::init(File *file, int mode, int threads, const char *saved) {
+    stats = TableStats();
+    PhaseMark mark(stats);
     //init settings
-    this->rules = file2Rules(file);
-    MappedRules mapped = mapRules(rules);
-    set<int> ids = allIdsFromFile(file);
-    set<int> complexIds = complexIdsFromFile(file);
+    this->symbols = SymbolTable(file);
+    this->mapping.clear();
+    for (int i = 0; i < symbols.size(); i++) mapping[symbols.id(i)] = i;
+    this->rules = file2Rules(file, rulePool, symbols);
+    MappedRules mapped = mapRules(rules, symbols.size());
+    vector<Link> links;
+    mark.charge(PHASE_LOAD);
+    FirstSets firsts(mapped);
+    ClosureTemplates templates(mapped, firsts);
+    mark.charge(PHASE_FIRST);
+    int nstates;
+    if (mode == BUILD_LALR) {
+        if (!(saved && updateLR0(mapped, templates, saved))) buildLR0(templates, threads);
+        mark.charge(PHASE_CLOSURE);
+        nstates = lookaheads(mapped, firsts, links);
+        mark.charge(PHASE_LOOKAHEAD);
+        for (int s = 0; s < lr0.size(); s++) {
+            stats.kernelItems += lr0[s].kernel.size();
+            stats.closureItems += lr0[s].items.size();
+        }
+    } else {
+        nstates = buildMerged(templates, firsts, links);
+        mark.charge(PHASE_CLOSURE);
+        for (int s = 0; s < states.size(); s++) {
+            const auto &items = states[s]->getItems();
+            for (auto it = items.begin(); it != items.end(); it++) {
+                if ((*it)->getPosition() > 0 || (*it)->getRule()->getIndex() == 0) stats.kernelItems++;
+            }
+            stats.closureItems += items.size();
+        }
+    }
+    //interleaved phases were timed inside the closure phase
+    stats.seconds[PHASE_CLOSURE] -= stats.seconds[PHASE_DEDUP];
+    if (mode != BUILD_LALR) stats.seconds[PHASE_CLOSURE] -= stats.seconds[PHASE_LOOKAHEAD];
+    this->table = createTable(links, symbols, nstates, this->defaults, stats);
+    mark.charge(PHASE_TABLE);
+    stats.states = nstates;
+    stats.poolBytes = rulePool.bytes() + itemPool.bytes() + closurePool.bytes();
+}
+
+int LRTable::buildMerged(const ClosureTemplates &templates, FirstSets &firsts, vector<Link> &links) {
     //init for construction
-    Item *first = new Item(rules[0], 0, getEOFEnding());
+    Item *first = itemPool.make(rules[0], 0, getEOFEnding());
     deque<Closure *> next;
-    vector<Link> links;
-    set<Closure *, decltype(closurecmp)*> visited(closurecmp);
-    set<Item *> initialItems;
-    initialItems.insert(first);
-    Closure *start = new Closure(mapped, initialItems, 0);
+    KernelIndex visited;
+    vector<Item *> initialItems(1, first);
+    Closure *start = closurePool.make(templates, firsts, itemPool, initialItems, visited.insert(kernelOf(initialItems)));
     //start bfs for constuction
     next.push_back(start);
-    visited.insert(start);
     this->states.push_back(start);
     while(!next.empty()) {
         auto node = next.front();
         next.pop_front();
-        auto edges = node->advanceItems();
-        bool isEnd = true;
-        for (auto it = ids.begin(); it != ids.end(); it++) {
-            if (edges[*it].empty()) continue;
-            isEnd = false;
-            Closure *newClosure = new Closure(mapped, edges[*it], visited.size());
-            if (visited.count(newClosure)) {
-                if (!isEndingEqual((*visited.find(newClosure)), newClosure)) {
-                    (*visited.find(newClosure))->combineEndings(newClosure);
-                    next.push_back(*visited.find(newClosure));
+        Edges edges = node->advanceItems(itemPool);
+        bool isEnd = edges.shifts.empty() && edges.reduces.empty();
+        for (int e = 0; e < edges.shifts.size(); e++) {
+            int symbol = edges.shifts[e].symbol;
+            const vector<Item *> &items = edges.shifts[e].items;
+            double start = wallSeconds();
+            vector<LR0Item> kernel = kernelOf(items);
+            int target = visited.find(kernel);
+            stats.seconds[PHASE_DEDUP] += wallSeconds() - start;
+            if (target >= 0) {
+                //only re-close a known kernel when it brings new endings
+                start = wallSeconds();
+                Closure *old = this->states[target];
+                bool covered = true;
+                for (auto item = items.begin(); covered && item != items.end(); item++) {
+                    Item *oldItem = old->find(*item);
+                    if (!oldItem) {
+                        covered = false;
+                        break;
+                    }
+                    const set<int> &oldEndings = oldItem->getEndings();
+                    const set<int> &endings = (*item)->getEndings();
+                    covered = includes(oldEndings.begin(), oldEndings.end(), endings.begin(), endings.end());
+                }
+                if (!covered) {
+                    Closure *newClosure = closurePool.make(templates, firsts, itemPool, items, target);
+                    old->combineEndings(newClosure);
+                    next.push_back(old);
+                    releaseClosure(newClosure);
+                    stats.reenqueues++;
+                } else {
+                    for (auto item = items.begin(); item != items.end(); item++) {
+                        itemPool.release(*item);
+                    }
                 }
-                links.push_back(makeLink(node->getState(), (*visited.find(newClosure))->getState(), 
-                    complexIds.count(*it) ? GOTO : SHIFT, *it));
+                stats.seconds[PHASE_LOOKAHEAD] += wallSeconds() - start;
+                links.push_back(makeLink(node->getState(), target, 
+                    symbols.isTerminal(symbol) ? SHIFT : GOTO, symbol));
                 continue;
             }
+            start = wallSeconds();
+            int state = visited.insert(kernel);
+            stats.seconds[PHASE_DEDUP] += wallSeconds() - start;
+            Closure *newClosure = closurePool.make(templates, firsts, itemPool, items, state);
             links.push_back(makeLink(node->getState(), newClosure->getState(), 
-                complexIds.count(*it) ? GOTO : SHIFT, *it));
-            visited.insert(newClosure);
+                symbols.isTerminal(symbol) ? SHIFT : GOTO, symbol));
             next.push_back(newClosure);
             this->states.push_back(newClosure);
         }
-        for (auto it = ids.begin(); it != ids.end(); it++) {
-            int index = -*it-1;
-            if (edges[index].empty()) continue;
-            isEnd = false;
-            links.push_back(makeLink(node->getState(), (*edges[index].begin())->getRule()->getIndex(), 
-                REDUCE, *it));
+        for (int e = 0; e < edges.reduces.size(); e++) {
+            links.push_back(makeLink(node->getState(), edges.reduces[e].item->getRule()->getIndex(), 
+                REDUCE, edges.reduces[e].ending));
         }
         if (isEnd) {
-            for (auto it = ids.begin(); it != ids.end(); it++) {
-                links.push_back(makeLink(node->getState(), 0, ACCEPT, *it));
+            for (int symbol = 0; symbol < symbols.size(); symbol++) {
+                links.push_back(makeLink(node->getState(), 0, ACCEPT, symbol));
             }
         }
     }
-    this->table = createTable(links, rules, ids, complexIds, states.size(), this->id2index);
+    return states.size();
+}
+
+//hand a speculative closure and all of its items back to the pools
+void LRTable::releaseClosure(Closure *closure) {
+    const auto &items = closure->getItems();
+    for (auto it = items.begin(); it != items.end(); it++) {
+        itemPool.release(*it);
+    }
+    closurePool.release(closure);
 }
 
 int LRTable::getIndex(int id) {
-    return id2index[id];
+    return symbols.symbol(id);
 }
 
-vector<vector<action>> LRTable::getTable() {
+const vector<vector<action>> &LRTable::getTable() {
     return table;
 }
 
-map<int, int> LRTable::getMapping() {
-    return id2index;
-}
\ No newline at end of file
+const vector<int> &LRTable::getDefaults() {
+    return defaults;
+}
+
+const map<int, int> &LRTable::getMapping() {
+    return mapping;
+}
+
+int LRTable::getTerminals() {
+    return symbols.terminals();
+}
+
+const SymbolTable &LRTable::getSymbols() {
+    return symbols;
+}
+
+const Rules &LRTable::getRules() {
+    return rules;
+}
+
+const TableStats &LRTable::getStats() {
+    return stats;
+}
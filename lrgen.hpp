@@ -2,13 +2,37 @@
 #define LRGEN_HPP
 
 #include "syntaxparser.hpp"
+#include "pool.hpp"
+#include <mutex>
 #include <vector>
 #include <set>
 #include <map>
+#include <stdint.h>
 
 using namespace std;
 
 
+/*
+ * Grammar ids interned into symbols 0..size()-1, terminals first and
+ * nonterminals after them, each group in id order. A symbol is the
+ * column of its id in the parse table.
+ */
+class SymbolTable {
+private:
+    vector<int> mIds;                   //symbol -> id
+    vector<pair<int, int>> mSymbols;    //(id, symbol), sorted by id
+    int mTerminals;
+public:
+    SymbolTable();
+    SymbolTable(File *file);
+    int symbol(int id) const;
+    int id(int symbol) const;
+    int size() const;
+    int terminals() const;
+    bool isTerminal(int symbol) const;
+};
+
+//a rule over symbols of a SymbolTable, or over raw grammar ids without one
 class Rule {
 private:
     int mIndex;
@@ -16,17 +40,53 @@ private:
     vector<int> mTo;
 public:
     Rule(Line *line, int index);
+    Rule(Line *line, int index, const SymbolTable &symbols);
     int getFrom();
     int getTo(int index);
     int getSize();
     int getIndex();
 };
 typedef vector<Rule *> Rules;
-typedef map<int, vector<Rule *>> MappedRules;
-MappedRules mapRules(const Rules &rules);
-set<int> first(int id, MappedRules &rules);
-void printRules(Rules rules);
+typedef vector<vector<Rule *>> MappedRules;     //rules by left side symbol
+MappedRules mapRules(const Rules &rules, int symbols);
+
+/*
+ * FIRST and nullable for every symbol of a grammar, computed once in time
+ * linear in the rules. Symbols without rules are terminals.
+ */
+class FirstSets {
+private:
+    vector<set<int>> mFirst;
+    vector<bool> mNullable;
+public:
+    FirstSets(MappedRules &rules);
+    const set<int> &first(int id);
+    bool isNullable(int id);
+    set<int> firstOf(Rule *rule, int index, const set<int> &endings);
+};
+/*
+ * What predicting a nonterminal pulls into a closure, worked out once per
+ * grammar: every rule that can start a derivation of it, with the
+ * lookaheads the rule gets from inside that derivation (spontaneous) and
+ * whether the predicting item's own lookahead reaches it (propagated).
+ */
+struct ClosureTemplate {
+    vector<int> predicted;          //nonterminals reached, the root first
+    vector<Rule *> rules;           //their rules, grouped by nonterminal
+    vector<set<int>> spontaneous;   //per rule
+    vector<bool> propagated;        //per rule
+};
+
+class ClosureTemplates {
+private:
+    vector<ClosureTemplate> mTemplates;     //by symbol, empty for terminals
+public:
+    ClosureTemplates(MappedRules &rules, FirstSets &firsts);
+    const ClosureTemplate *find(int id) const;
+};
+void printRules(const Rules &rules);
 Rules file2Rules(File *file);
+Rules file2Rules(File *file, Pool<Rule> &pool, const SymbolTable &symbols);
 
 class Item
 {
@@ -35,18 +95,37 @@ private:
     int mIndex;
     set<int> mEndings;
 public:
-    Item(Rule *rule, int index, set<int> endings);
+    Item(Rule *rule, int index, const set<int> &endings);
     int next();
     int doubleNext();
-    void unionEnding(set<int> endings);
-    Item *advance();
+    void unionEnding(const set<int> &endings);
+    Item *advance(Pool<Item> &pool);
+    int getPosition();
     bool compare(Item *item);
-    set<int> getEndings();
+    const set<int> &getEndings();
     Rule *getRule();
 };
 
 bool itemcmp(Item * const &a, Item * const &b);
 
+//items shifted over one symbol, the kernel of the target state
+struct Transition {
+    int symbol;
+    vector<Item *> items;
+};
+
+//completed item reduced on one lookahead
+struct Reduction {
+    int ending;
+    Item *item;
+};
+
+//edges out of a closure, each sorted by symbol
+struct Edges {
+    vector<Transition> shifts;
+    vector<Reduction> reduces;
+};
+
 class Closure {
 private:
     set<Item *, decltype(itemcmp)*> mItems;
@@ -54,10 +133,11 @@ private:
 public:
     int getState();
     bool compare(Closure *closure);
-    Closure(MappedRules &rules, set<Item *> items, int state);
-    map<int, set<Item *>> advanceItems();
+    Closure(const ClosureTemplates &templates, FirstSets &firsts, Pool<Item> &pool, const vector<Item *> &items, int state);
+    Edges advanceItems(Pool<Item> &pool);
     void combineEndings(Closure *closure);
-    set<Item *, decltype(itemcmp)*> getItems();
+    Item *find(Item *item);
+    const set<Item *, decltype(itemcmp)*> &getItems();
 };
 
 bool closurecmp(Closure * const &a, Closure * const &b);
@@ -66,20 +146,156 @@ struct Link {
     int fromState;
     int num;
     int action;
-    int id;
+    int symbol;
+};
+
+Link makeLink(int from, int to, int action, int symbol);
+
+//construction modes
+#define BUILD_MERGE 0   //LR(1) closures, merged on equal cores
+#define BUILD_LALR  1   //LR(0) automaton + DeRemer-Pennello lookaheads
+
+typedef pair<int, int> LR0Item;     //rule index, dot position
+
+vector<LR0Item> kernelOf(const vector<Item *> &items);
+uint64_t hashKernel(const vector<LR0Item> &kernel);
+
+/*
+ * Open-addressing index from kernel hash to state number. States are
+ * numbered in insertion order and full kernels are only compared when
+ * two hashes collide.
+ */
+class KernelIndex {
+private:
+    vector<uint64_t> mHashes;
+    vector<int> mSlots;
+    vector<vector<LR0Item>> mKernels;
+    int probe(const vector<LR0Item> &kernel, uint64_t hash);
+    void grow();
+public:
+    KernelIndex();
+    int find(const vector<LR0Item> &kernel);
+    int insert(const vector<LR0Item> &kernel);
+    int insert(const vector<LR0Item> &kernel, uint64_t hash);
+    const vector<LR0Item> &kernel(int state);
+    int size();
+};
+
+/*
+ * KernelIndex split into locked shards so several threads can intern
+ * kernels at once. Ids are unique but depend on thread timing; callers
+ * that need stable numbers renumber them in a serial pass.
+ */
+#define KERNEL_SHARD_BITS 6
+
+class ConcurrentKernelIndex {
+private:
+    KernelIndex mShards[1 << KERNEL_SHARD_BITS];
+    mutex mLocks[1 << KERNEL_SHARD_BITS];
+public:
+    int intern(const vector<LR0Item> &kernel);
+    const vector<LR0Item> &kernel(int id);
+};
+
+struct LR0State {
+    vector<LR0Item> kernel;         //empty for a retired state
+    vector<LR0Item> items;
+    vector<int> predicted;          //nonterminals the closure expanded
+    map<int, int> gotos;            //symbol -> state
+};
+
+/*
+ * A set of small ints per row, one bit each, rows laid out back to back
+ * so a union is a loop over words.
+ */
+class BitSets {
+private:
+    int mWords;
+    vector<uint64_t> mBits;
+public:
+    BitSets(int rows, int universe);
+    void insert(int row, int value);
+    void unite(int row, int other);     //row |= other
+    void assign(int row, int other);
+    void clear(int row);
+    vector<int> values(int row) const;
+};
+
+//F(x) = F'(x) U {F(y) | x R y}, sets holds F' on entry and F on return
+void digraph(const vector<vector<int>> &relation, BitSets &sets);
+
+vector<LR0Item> closeKernel(const vector<LR0Item> &kernel, const Rules &rules, const ClosureTemplates &templates, vector<int> &predicted);
+vector<pair<int, vector<LR0Item>>> gotoKernels(const vector<LR0Item> &items, const Rules &rules);
+
+//phases of a table construction, in the order they run
+enum {
+    PHASE_LOAD,         //rules and symbol sets from the file
+    PHASE_FIRST,        //FIRST, nullable and closure templates
+    PHASE_CLOSURE,      //closing and expanding states
+    PHASE_DEDUP,        //kernel hashing and interning
+    PHASE_LOOKAHEAD,    //endings merges or DeRemer-Pennello sets
+    PHASE_TABLE,        //createTable
+    PHASE_COUNT
+};
+const char *phaseName(int phase);
+double wallSeconds();
+long heapInUse();
+
+/*
+ * What building one table cost. Heap growth is what the allocator holds
+ * after a phase minus before it, so it may be negative. Phases that run
+ * interleaved split their time but count their heap under the enclosing
+ * phase (dedup and lookahead merges under closure). On the thread pool a
+ * level's wall time is split by the time its tasks spent in each phase.
+ */
+struct TableStats {
+    double seconds[PHASE_COUNT];
+    long bytes[PHASE_COUNT];
+    int states;
+    long kernelItems;
+    long closureItems;
+    int reenqueues;         //known states closed again by combineEndings
+    int shiftReduce;        //entries with a shift/reduce conflict, the reduction wins
+    int reduceReduce;       //entries with a reduce/reduce conflict, the lowest rule wins
+    size_t poolBytes;       //slabs of the rule, item and closure pools
 };
 
+/*
+ * Rules, items and closures of a table live in its pools and are
+ * released together when the table is destroyed.
+ */
 class LRTable {
 private:
+    Pool<Rule> rulePool;
+    Pool<Item> itemPool;
+    Pool<Closure> closurePool;
     Rules rules;
     vector<Closure *> states;
+    vector<LR0State> lr0;
     vector<vector<action>> table;
-    map<int, int> id2index;
+    vector<int> defaults;
+    SymbolTable symbols;
+    map<int, int> mapping;      //id -> column
+    TableStats stats;
+    void releaseClosure(Closure *closure);
+    int buildMerged(const ClosureTemplates &templates, FirstSets &firsts, vector<Link> &links);
+    void buildLR0(const ClosureTemplates &templates, int threads);
+    bool updateLR0(const MappedRules &mapped, const ClosureTemplates &templates, const char *saved);
+    int lookaheads(MappedRules &mapped, FirstSets &firsts, vector<Link> &links);
+    void init(File *file, int mode, int threads, const char *saved);
 public:
-    LRTable(File *file);
-    vector<vector<action>> getTable();
+    LRTable(File *file, int mode = BUILD_MERGE, int threads = 1);
+    LRTable(File *file, const char *saved, int threads = 1);
+    bool save(const char *path);
+    LRTable(const LRTable &) = delete;
+    const vector<vector<action>> &getTable();
+    const vector<int> &getDefaults();
     int getIndex(int id);
-    map<int, int> getMapping();
+    const map<int, int> &getMapping();
+    int getTerminals();
+    const SymbolTable &getSymbols();
+    const Rules &getRules();     //over symbols, see getSymbols()
+    const TableStats &getStats();
 };
 
 #endif
\ No newline at end of file
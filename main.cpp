@@ -2,6 +2,12 @@
 #include "syntaxparser.hpp"
 #include "reader.hpp"
 #include "lrgen.hpp"
+#include "tableimage.hpp"
+#include "codegen.hpp"
+#include "batch.hpp"
+#include "scanner.hpp"
+#include <string.h>
+#include <stdlib.h>
 
 
 void printFile(File *file);
@@ -45,7 +51,7 @@ void printDigit(Digits *digits) {
     printDigit(digits->next);
 }
 
-void printTable(const vector<vector<action>> &actions) {
+void printTable(const vector<vector<action>> &actions, const vector<int> &defaults) {
     printf("print table\n");
     for (int i = 0; i < actions.size(); i++) {
         printf("%d: ", i);
@@ -69,15 +75,295 @@ void printTable(const vector<vector<action>> &actions) {
                 printf(" ");
             }
         }
+        if (defaults[i] >= 0) printf("default r%d", defaults[i]);
         printf("\n");
     }
 }
 
-int main() {
-    File *file = parse(new FileReader("syntax.lr"));
-    LRTable *table = new LRTable(file);
-    printTable(table->getTable());
-    File *test = parse(new FileReader("syntax.lr"), table->getTable(), table->getMapping());
+void printStats(const TableStats &stats) {
+    printf("states %d\n", stats.states);
+    printf("kernel items %ld\n", stats.kernelItems);
+    printf("closure items %ld\n", stats.closureItems);
+    printf("reenqueues %d\n", stats.reenqueues);
+    printf("conflicts %d shift/reduce, %d reduce/reduce\n", stats.shiftReduce, stats.reduceReduce);
+    printf("pool bytes %zu\n", stats.poolBytes);
+    double total = 0;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        printf("%-10s %10.6f s %12ld bytes\n", phaseName(i), stats.seconds[i], stats.bytes[i]);
+        total += stats.seconds[i];
+    }
+    printf("%-10s %10.6f s\n", "total", total);
+}
+
+/*
+ * Whether two tables of one grammar are the same automaton up to state
+ * numbers. States are paired from the start state along shifts and gotos,
+ * paired states must have the same actions and default reduction. States
+ * no action leads to, retired ones or shifts lost to a conflict, are left
+ * out.
+ */
+static bool sameAutomaton(LRTable &a, LRTable &b) {
+    const vector<vector<action>> &ta = a.getTable();
+    const vector<vector<action>> &tb = b.getTable();
+    vector<int> pairOf(ta.size(), -1);
+    vector<bool> taken(tb.size(), false);
+    vector<int> work(1, 0);
+    pairOf[0] = 0;
+    taken[0] = true;
+    while (!work.empty()) {
+        int s = work.back();
+        int t = pairOf[s];
+        work.pop_back();
+        if (ta[s].size() != tb[t].size() || a.getDefaults()[s] != b.getDefaults()[t]) return false;
+        for (int i = 0; i < ta[s].size(); i++) {
+            action x = ta[s][i];
+            action y = tb[t][i];
+            if (x.type != y.type) return false;
+            if (x.type != SHIFT && x.type != GOTO) {
+                if (x.num != y.num) return false;
+                continue;
+            }
+            if (pairOf[x.num] < 0 && !taken[y.num]) {
+                pairOf[x.num] = y.num;
+                taken[y.num] = true;
+                work.push_back(x.num);
+            }
+            if (pairOf[x.num] != y.num) return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * LALR table of file from the automaton saved at state, when there is
+ * one, and the new automaton saved there. With check a build from
+ * scratch must give the same automaton, NULL when it does not.
+ */
+static LRTable *incrementalTable(File *file, const char *state, int threads, bool check) {
+    LRTable *table = new LRTable(file, state, threads);
+    if (check) {
+        LRTable scratch(file, BUILD_LALR, threads);
+        bool same = sameAutomaton(*table, scratch);
+        printf("incremental table %s a full build, %d states, %d numbered\n", same ? "matches" : "differs from",
+            (int)scratch.getTable().size(), (int)table->getTable().size());
+        if (!same) {
+            delete table;
+            return NULL;
+        }
+    }
+    if (!table->save(state)) printf("cannot write %s\n", state);
+    return table;
+}
+
+/*
+ * Parses the .lr file at path a token at a time: the scanner makes one
+ * token of every /digits id, the table of tokens.lr builds the tree.
+ */
+static File *scanParse(const char *path, Arena &arena) {
+    MmapReader in(path);
+    if (!in.valid()) {
+        printf("cannot open %s\n", path);
+        return NULL;
+    }
+    //the scanner wants the input in one piece, pipes are collected first
+    size_t size;
+    const char *text = in.window(size);
+    string piped;
+    if (!in.mapped()) {
+        for (; size; text = in.window(size)) {
+            piped.append(text, size);
+            in.skip(size);
+        }
+        if (in.error()) {
+            printf("cannot read %s\n", path);
+            return NULL;
+        }
+        text = piped.data();
+        size = piped.size();
+    }
+    //token ids are the terminal ids of tokens.c
+    ScannerTable tokens;
+    tokens.add("/[0-9]+", 0);
+    tokens.add(">", 1);
+    tokens.add("\\n", 2);
+    tokens.build();
+    LRTable table(parse(new FileReader("tokens.lr"), arena), BUILD_LALR);
+    PackedTable packed(table.getTable(), table.getTerminals(), table.getDefaults());
+    ActionRegistry<void *> actions(table.getRules());
+    actions.on(1, [&](void **v) -> void * { return arena.make<File>((Line *)v[0], (File *)NULL); });
+    actions.on(2, [&](void **v) -> void * { return arena.make<File>((Line *)v[0], (File *)v[2]); });
+    actions.on(3, [&](void **v) -> void * { return arena.make<Line>((Exp *)v[2], (Id *)v[0]); });
+    actions.on(4, [&](void **v) -> void * { return arena.make<Exp>((Id *)v[0], (Exp *)v[1]); });
+    actions.on(5, [&](void **v) -> void * { return arena.make<Exp>((Id *)v[0], (Exp *)NULL); });
+    Engine<void *> engine(packed, actions, table.getIndex(3));
+    vector<int> columns;
+    for (int id = 0; id < 3; id++) columns.push_back(table.getIndex(id));
+    int count = 0;
+    Scanner scanner(tokens, text, size);
+    Token bad;
+    int status = feedTokens<void *>(scanner, engine, columns, [&](const Token &tok) -> void * {
+        count++;
+        if (tok.id != 0) return NULL;
+        Digits *digits = NULL;
+        for (size_t i = tok.offset + tok.length - 1; i > tok.offset; i--) {
+            digits = arena.make<Digits>((int)text[i], digits);
+        }
+        return arena.make<Id>(digits);
+    }, &bad);
+    if (status != PARSE_DONE) {
+        printf("syntax error at byte %zu\n", bad.offset);
+        return NULL;
+    }
+    printf("%zu bytes, %d tokens, %d scanner states, %d table states\n",
+        size, count, tokens.states(), (int)table.getTable().size());
+    return (File *)engine.result();
+}
+
+//same rules in the same order, the reductions of the parser only fit those of syntax.lr
+static bool sameRules(File *a, File *b) {
+    Rules x = file2Rules(a), y = file2Rules(b);
+    bool same = x.size() == y.size();
+    for (int i = 0; same && i < x.size(); i++) {
+        same = x[i]->getFrom() == y[i]->getFrom() && x[i]->getSize() == y[i]->getSize();
+        for (int j = 0; same && j < x[i]->getSize(); j++) same = x[i]->getTo(j) == y[i]->getTo(j);
+    }
+    for (Rule *r: x) delete r;
+    for (Rule *r: y) delete r;
+    return same;
+}
+
+int main(int argc, char **argv) {
+    const char *cache = NULL;
+    const char *direct = NULL;
+    const char *grammar = "syntax.lr";
+    const char *scan = NULL;
+    const char *state = NULL;
+    bool stats = false;
+    bool check = false;
+    bool batch = false;
+    bool ownGrammar = false;
+    vector<string> inputs;
+    int mode = BUILD_LALR;
+    int threads = 1;
+    Arena arena;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--cache") && i+1 < argc) cache = argv[++i];
+        else if (!strcmp(argv[i], "--direct") && i+1 < argc) direct = argv[++i];
+        else if (!strcmp(argv[i], "--grammar") && i+1 < argc) {
+            grammar = argv[++i];
+            ownGrammar = true;
+        }
+        else if (!strcmp(argv[i], "--threads") && i+1 < argc) threads = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--scan") && i+1 < argc) scan = argv[++i];
+        else if (!strcmp(argv[i], "--state") && i+1 < argc) state = argv[++i];
+        else if (!strcmp(argv[i], "--check")) check = true;
+        else if (!strcmp(argv[i], "--merge")) mode = BUILD_MERGE;
+        else if (!strcmp(argv[i], "--stats")) stats = true;
+        else if (!strcmp(argv[i], "--batch")) batch = true;
+        else if (argv[i][0] != '-') inputs.push_back(argv[i]);
+        else {
+            printf("unknown option %s\n", argv[i]);
+            return -1;
+        }
+    }
+    if (!inputs.empty() && !batch) {
+        printf("%s: inputs are only read with --batch\n", inputs[0].c_str());
+        return -1;
+    }
+    if (scan) {
+        //parse a .lr file through the scanner and the token grammar
+        File *tree = scanParse(scan, arena);
+        if (!tree) return 1;
+        printRules(file2Rules(tree));
+        return 0;
+    }
+    if (batch) {
+        //check every input, against the table of --grammar if one was given
+        vector<BatchResult> results;
+        if (ownGrammar) {
+            File *file = parse(new FileReader(grammar), arena);
+            if (!sameRules(file, parse(new FileReader("syntax.lr"), arena))) {
+                printf("%s: --batch needs the rules of syntax.lr\n", grammar);
+                return -1;
+            }
+            LRTable table(file, BUILD_LALR);
+            PackedTable packed(table.getTable(), table.getTerminals(), table.getDefaults());
+            results = parseBatch(inputs, packed, table.getMapping(), threads);
+        } else {
+            results = parseBatch(inputs, threads);
+        }
+        int failed = 0;
+        for (int i = 0; i < results.size(); i++) {
+            if (results[i].status == PARSE_DONE) {
+                printf("%s: ok, %d lines\n", inputs[i].c_str(), results[i].lines);
+                continue;
+            }
+            const vector<Diagnostic> &diags = results[i].diagnostics;
+            for (int d = 0; d < diags.size(); d++) {
+                printf("%s: syntax error at byte %zu, state %d, entry %d\n",
+                    inputs[i].c_str(), diags[d].offset, diags[d].state, diags[d].entry);
+            }
+            if (diags.empty()) printf("%s: %s\n", inputs[i].c_str(), results[i].message.c_str());
+            failed++;
+        }
+        printf("%d of %d files accepted\n", (int)results.size() - failed, (int)results.size());
+        return failed ? 1 : 0;
+    }
+    if (state && mode != BUILD_LALR) {
+        printf("--state only works with LALR tables\n");
+        return -1;
+    }
+    if (stats) {
+        //only build the table for grammar and report what it cost
+        File *file = parse(new FileReader(grammar), arena);
+        LRTable *table = state ? incrementalTable(file, state, threads, check) : new LRTable(file, mode, threads);
+        if (!table) return 1;
+        printStats(table->getStats());
+        delete table;
+        return 0;
+    }
+    if (direct) {
+        //only emit a direct-coded parser for grammar
+        File *file = parse(new FileReader(grammar), arena);
+        LRTable *table = state ? incrementalTable(file, state, threads, check) : new LRTable(file, BUILD_LALR);
+        if (!table) return 1;
+        bool written = writeDirectParser(direct, *table, "parseDirect");
+        delete table;
+        if (!written) {
+            printf("cannot write %s\n", direct);
+            return -1;
+        }
+        return 0;
+    }
+    File *file = parse(new FileReader("syntax.lr"), arena);
+    File *test;
+    if (cache) {
+        //table comes mapped from the cache, generated only on a miss
+        TableImage *image = cachedTable(file, cache);
+        if (!image) {
+            printf("cannot use table cache %s\n", cache);
+            return -1;
+        }
+        test = parse(new FileReader("syntax.lr"), arena, image->table(), [&](int id) { return image->column(id); });
+    } else {
+        LRTable *table = new LRTable(file, BUILD_LALR);
+        printTable(table->getTable(), table->getDefaults());
+        test = parse(new FileReader("syntax.lr"), arena, table->getTable(), table->getMapping(), table->getDefaults());
+    }
     auto testRules = file2Rules(test);
     printRules(testRules);
+    //the same bytes from memory must give the same tree as from the file
+    FileReader bytes("syntax.lr");
+    string text;
+    size_t size;
+    for (const char *w = bytes.window(size); size; w = bytes.window(size)) {
+        text.append(w, size);
+        bytes.skip(size);
+    }
+    MemoryReader memory(text.data(), text.size());
+    if (!sameRules(file, parse(&memory, arena))) {
+        printf("memory reader parse differs\n");
+        return 1;
+    }
+    printf("memory reader parse matches, %zu bytes\n", text.size());
 }
\ No newline at end of file
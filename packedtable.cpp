@@ -0,0 +1,155 @@
+#include "packedtable.hpp"
+#include <algorithm>
+
+typedef vector<pair<int, uint32_t>> SparseRow;     //index, packed action
+
+//first fit of the rows, densest first, into one vector
+static void comb(const vector<SparseRow> &rows, vector<int32_t> &base, vector<int32_t> &check, vector<uint32_t> &values) {
+    vector<int> order;
+    for (int i = 0; i < rows.size(); i++) order.push_back(i);
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return rows[a].size() > rows[b].size();
+    });
+    base.assign(rows.size(), 0);
+    int firstFree = 0;
+    for (int k = 0; k < order.size(); k++) {
+        const SparseRow &row = rows[order[k]];
+        if (row.empty()) continue;
+        int b = max(0, firstFree - row[0].first);
+        while (1) {
+            int i = 0;
+            while (i < row.size() && (b+row[i].first >= check.size() || check[b+row[i].first] < 0)) i++;
+            if (i == row.size()) break;
+            b++;
+        }
+        for (int i = 0; i < row.size(); i++) {
+            int slot = b+row[i].first;
+            if (slot >= check.size()) {
+                check.resize(slot+1, -1);
+                values.resize(slot+1, PACK(FAIL, 0));
+            }
+            check[slot] = order[k];
+            values[slot] = row[i].second;
+        }
+        base[order[k]] = b;
+        while (firstFree < check.size() && check[firstFree] >= 0) firstFree++;
+    }
+}
+
+//terminals come first, so they end at the last column anything shifts or reduces on
+static int terminalColumns(const vector<vector<action>> &table) {
+    int res = 0;
+    for (int s = 0; s < table.size(); s++) {
+        for (int c = res; c < table[s].size(); c++) {
+            if (table[s][c].type == SHIFT || table[s][c].type == REDUCE) res = c+1;
+        }
+    }
+    return res;
+}
+
+//the rule a state reduces by whatever comes next, or -1
+int consistentReduction(const vector<action> &row, int terminals) {
+    int rule = -1;
+    for (int c = 0; c < terminals; c++) {
+        if (row[c].type == FAIL) continue;
+        if (row[c].type != REDUCE || (rule >= 0 && row[c].num != rule)) return -1;
+        rule = row[c].num;
+    }
+    return rule;
+}
+
+PackedTable::PackedTable(const vector<vector<action>> &table, int terminals, const vector<int> &defaults) {
+    int states = table.size();
+    int columns = table.empty() ? 0 : table[0].size();
+    if (terminals < 0) terminals = terminalColumns(table);
+    vector<SparseRow> rows(states);
+    vector<SparseRow> gotoRows(columns-terminals);
+    mDefaultReduce.assign(states, -1);
+    for (int s = 0; s < states; s++) {
+        mDefaultReduce[s] = defaults.empty() ? consistentReduction(table[s], terminals) : defaults[s];
+        for (int c = 0; c < columns; c++) {
+            if (table[s][c].type == FAIL) continue;
+            if (c < terminals && mDefaultReduce[s] >= 0) continue;
+            uint32_t packed = PACK(table[s][c].type, table[s][c].num);
+            if (c < terminals) rows[s].push_back(SparseRow::value_type(c, packed));
+            else gotoRows[c-terminals].push_back(SparseRow::value_type(s, packed));
+        }
+    }
+    //the most common goto of a nonterminal column becomes its default
+    mDefaultGoto.assign(gotoRows.size(), PACK(FAIL, 0));
+    for (int c = 0; c < gotoRows.size(); c++) {
+        map<uint32_t, int> counts;
+        int best = 0;
+        for (int i = 0; i < gotoRows[c].size(); i++) {
+            if (PACKED_TYPE(gotoRows[c][i].second) != GOTO) continue;
+            int n = ++counts[gotoRows[c][i].second];
+            if (n > best) {
+                best = n;
+                mDefaultGoto[c] = gotoRows[c][i].second;
+            }
+        }
+        SparseRow rest;
+        for (int i = 0; i < gotoRows[c].size(); i++) {
+            if (gotoRows[c][i].second != mDefaultGoto[c]) rest.push_back(gotoRows[c][i]);
+        }
+        gotoRows[c] = rest;
+    }
+    comb(rows, mBase, mCheck, mActions);
+    comb(gotoRows, mGotoBase, mGotoCheck, mGotos);
+    mArrays.states = states;
+    mArrays.columns = columns;
+    mArrays.terminals = terminals;
+    mArrays.actionSize = mActions.size();
+    mArrays.gotoSize = mGotos.size();
+    mArrays.base = mBase.data();
+    mArrays.defaultReduce = mDefaultReduce.data();
+    mArrays.check = mCheck.data();
+    mArrays.actions = mActions.data();
+    mArrays.defaultGoto = mDefaultGoto.data();
+    mArrays.gotoBase = mGotoBase.data();
+    mArrays.gotoCheck = mGotoCheck.data();
+    mArrays.gotos = mGotos.data();
+}
+
+PackedTable::PackedTable(const PackedArrays &arrays) {
+    mArrays = arrays;
+}
+
+action PackedTable::lookup(int state, int column) const {
+    const PackedArrays &t = mArrays;
+    uint32_t packed;
+    if (column < t.terminals) {
+        int i = t.base[state] + column;
+        packed = i < t.actionSize && t.check[i] == state ? t.actions[i] : PACK(FAIL, 0);
+    } else {
+        int c = column - t.terminals;
+        int i = t.gotoBase[c] + state;
+        packed = i < t.gotoSize && t.gotoCheck[i] == c ? t.gotos[i] : t.defaultGoto[c];
+    }
+    return createAction(PACKED_TYPE(packed), PACKED_NUM(packed));
+}
+
+int PackedTable::defaultReduce(int state) const {
+    return mArrays.defaultReduce[state];
+}
+
+const PackedArrays &PackedTable::arrays() const {
+    return mArrays;
+}
+
+int PackedTable::states() const {
+    return mArrays.states;
+}
+
+int PackedTable::columns() const {
+    return mArrays.columns;
+}
+
+int PackedTable::terminals() const {
+    return mArrays.terminals;
+}
+
+size_t PackedTable::bytes() const {
+    const PackedArrays &t = mArrays;
+    return (2*t.states + 2*t.actionSize + 2*(t.columns-t.terminals) + 2*t.gotoSize) * sizeof(uint32_t);
+}
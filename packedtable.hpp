@@ -0,0 +1,68 @@
+#ifndef PACKED_TABLE_HPP
+#define PACKED_TABLE_HPP
+
+#include "syntaxparser.hpp"
+#include <stdint.h>
+
+//type in the low 3 bits, number above it
+#define PACK(t, n) ((uint32_t)(n) << 3 | (uint32_t)(t))
+#define PACKED_TYPE(p) ((int)((p) & 7))
+#define PACKED_NUM(p) ((int)((p) >> 3))
+
+/*
+ * Row displacement ("comb vector") form of an action table. Terminal
+ * columns of every state are overlaid in one vector, each entry tagged
+ * with the state that owns it. Nonterminal columns get a default goto,
+ * their most common one, and only the other entries go into a second
+ * comb indexed by state. Without a terminal count, terminals are taken
+ * to end at the last column that is shifted or reduced on.
+ *
+ * States with a default reduction reduce without looking at the next
+ * symbol. Defaults come from createTable, or are found here for states
+ * whose only terminal actions are one reduction.
+ */
+//array layout of a PackedTable, also the on-disk layout of table images
+struct PackedArrays {
+    int states;
+    int columns;
+    int terminals;
+    int actionSize;
+    int gotoSize;
+    const int32_t *base;            //[states]
+    const int32_t *defaultReduce;   //[states], rule or -1
+    const int32_t *check;           //[actionSize]
+    const uint32_t *actions;        //[actionSize]
+    const uint32_t *defaultGoto;    //[columns-terminals]
+    const int32_t *gotoBase;        //[columns-terminals]
+    const int32_t *gotoCheck;       //[gotoSize]
+    const uint32_t *gotos;          //[gotoSize]
+};
+
+int consistentReduction(const vector<action> &row, int terminals);
+
+class PackedTable {
+private:
+    PackedArrays mArrays;
+    vector<int32_t> mBase;
+    vector<int32_t> mDefaultReduce;
+    vector<int32_t> mCheck;
+    vector<uint32_t> mActions;
+    vector<uint32_t> mDefaultGoto;
+    vector<int32_t> mGotoBase;
+    vector<int32_t> mGotoCheck;
+    vector<uint32_t> mGotos;
+public:
+    PackedTable(const vector<vector<action>> &table, int terminals = -1, const vector<int> &defaults = vector<int>());
+    //view over arrays owned by someone else, e.g. a mapped file
+    PackedTable(const PackedArrays &arrays);
+    PackedTable(const PackedTable &) = delete;
+    action lookup(int state, int column) const;
+    int defaultReduce(int state) const;
+    const PackedArrays &arrays() const;
+    int states() const;
+    int columns() const;
+    int terminals() const;
+    size_t bytes() const;
+};
+
+#endif
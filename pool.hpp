@@ -0,0 +1,59 @@
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <vector>
+#include <new>
+#include <utility>
+
+/*
+ * Typed slab allocator. Objects are carved out of fixed size slabs,
+ * released objects go on a free list and are reused by later make()
+ * calls, and everything is destroyed in bulk with the pool.
+ */
+template <class T, int SLAB = 256>
+class Pool {
+private:
+    std::vector<T *> mSlabs;
+    std::vector<T *> mFree;
+    int mUsed;      //constructed objects in the last slab
+public:
+    Pool() : mUsed(SLAB) {}
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    template <class... Args>
+    T *make(Args&&... args) {
+        if (!mFree.empty()) {
+            T *obj = mFree.back();
+            mFree.pop_back();
+            *obj = T(std::forward<Args>(args)...);
+            return obj;
+        }
+        if (mUsed == SLAB) {
+            mSlabs.push_back((T *)::operator new(sizeof(T) * SLAB));
+            mUsed = 0;
+        }
+        T *obj = new (mSlabs.back() + mUsed) T(std::forward<Args>(args)...);
+        mUsed++;
+        return obj;
+    }
+
+    //obj stays constructed until make() hands it out again
+    void release(T *obj) {
+        mFree.push_back(obj);
+    }
+
+    size_t bytes() {
+        return mSlabs.size() * SLAB * sizeof(T);
+    }
+
+    ~Pool() {
+        for (int i = 0; i < mSlabs.size(); i++) {
+            int used = i+1 == mSlabs.size() ? mUsed : SLAB;
+            for (int j = 0; j < used; j++) mSlabs[i][j].~T();
+            ::operator delete(mSlabs[i]);
+        }
+    }
+};
+
+#endif
@@ -2,25 +2,150 @@
 #define READER_HPP
 
 #include <stdio.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
+/*
+ * Input of the parser. Bytes are consumed from a window [mCur, mEnd) with
+ * the inline next(), the virtual refill() only runs once the window is
+ * used up, so a reader pays one virtual call per chunk instead of one per
+ * byte. A reader implements getc(); by default it is refilled one byte at
+ * a time from it, readers with a buffer of their own override refill()
+ * and answer getc() from the window.
+ */
 class Reader {
+protected:
+    const char *mCur = NULL;
+    const char *mEnd = NULL;
+    char mByte;
+    //points the window at the next bytes, false at the end of input
+    virtual bool refill() {
+        char c = getc();
+        if (c == EOF) return false;
+        mByte = c;
+        mCur = &mByte;
+        mEnd = mCur+1;
+        return true;
+    }
 public:
+    virtual ~Reader() {}
+    //next byte as 0..255, EOF at the end of input
+    int next() {
+        if (mCur == mEnd && !refill()) return EOF;
+        return (unsigned char)*mCur++;
+    }
+    //the bytes left in the window, refilled first when empty; size 0 at the end of input
+    const char *window(size_t &size) {
+        if (mCur == mEnd && !refill()) {
+            size = 0;
+            return NULL;
+        }
+        size = mEnd - mCur;
+        return mCur;
+    }
+    //consumes n bytes of the window
+    void skip(size_t n) {
+        mCur += n;
+    }
     virtual char getc() = 0;
 };
 
+//reads a file through a large buffer of its own, no stdio per byte
 class FileReader: public Reader {
-    FILE *file;
+    static const size_t BUFFER_SIZE = 1 << 16;
+    char *buffer;
+    int mError;
+protected:
+    int fd;
+    bool refill() override {
+        if (fd < 0) return false;
+        if (!buffer) buffer = new char[BUFFER_SIZE];
+        ssize_t n;
+        while ((n = read(fd, buffer, BUFFER_SIZE)) < 0 && errno == EINTR);
+        if (n < 0) mError = errno;
+        if (n <= 0) return false;
+        mCur = buffer;
+        mEnd = buffer+n;
+        return true;
+    }
 public:
     FileReader(const char *filename) {
-        file = fopen(filename, "r");
+        fd = open(filename, O_RDONLY);
+        buffer = NULL;
+        mError = fd < 0 ? errno : 0;
+    }
+    ~FileReader() {
+        if (fd >= 0) close(fd);
+        delete[] buffer;
+    }
+    //false when the file could not be opened, error() tells why
+    bool valid() {
+        return fd >= 0;
+    }
+    //errno of the failed open or read, 0 if there was none
+    int error() {
+        return mError;
     }
     char getc() override {
-        if (!file) return EOF;
-        return fgetc(file);
+        return next();
     }
-    ~FileReader() {
-        if (file) fclose(file);
+};
+
+/*
+ * Maps a regular file whole, the window is the mapping. Pipes, FIFOs and
+ * character devices report no size and files that fail to map are read
+ * through the buffer of FileReader instead.
+ */
+class MmapReader: public FileReader {
+    void *data;
+    size_t size;
+protected:
+    bool refill() override {
+        return data ? false : FileReader::refill();
+    }
+public:
+    MmapReader(const char *filename): FileReader(filename) {
+        data = NULL;
+        size = 0;
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) return;
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            data = NULL;
+            return;
+        }
+        size = st.st_size;
+        madvise(data, size, MADV_SEQUENTIAL);
+        mCur = (const char *)data;
+        mEnd = mCur+size;
+    }
+    //true when the whole file is the first window
+    bool mapped() {
+        return data != NULL;
+    }
+    ~MmapReader() {
+        if (data) munmap(data, size);
+    }
+};
+
+//zero copy reader over bytes owned by the caller
+class MemoryReader: public Reader {
+protected:
+    bool refill() override {
+        return false;
+    }
+public:
+    MemoryReader(const char *data, size_t size) {
+        mCur = data;
+        mEnd = data+size;
+    }
+    char getc() override {
+        return next();
     }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,324 @@
+#include "scanner.hpp"
+#include <string.h>
+#include <algorithm>
+
+/*************************************************************
+ *                      PATTERNS
+*************************************************************/
+ScannerTable::ScannerTable() {
+    mClasses = 1;
+    memset(mClassOf, 0, sizeof(mClassOf));
+    mNext.assign(1, -1);
+    mAccept.assign(1, SCAN_ERROR);
+}
+
+int ScannerTable::state() {
+    NfaState s;
+    memset(s.set, 0, sizeof(s.set));
+    s.next = -1;
+    s.def = -1;
+    mNfa.push_back(s);
+    return mNfa.size() - 1;
+}
+
+static int escaped(char c) {
+    switch (c) {
+    case 'n': return '\n';
+    case 't': return '\t';
+    case 'r': return '\r';
+    case '0': return '\0';
+    default: return (unsigned char)c;
+    }
+}
+
+bool ScannerTable::parseClass(const char *&p, bool *set) {
+    bool negate = *p == '^';
+    if (negate) p++;
+    bool first = true;
+    while (*p && (*p != ']' || first)) {
+        first = false;
+        int lo = *p == '\\' && p[1] ? escaped(*++p) : (unsigned char)*p;
+        p++;
+        int hi = lo;
+        if (*p == '-' && p[1] && p[1] != ']') {
+            p++;
+            hi = *p == '\\' && p[1] ? escaped(*++p) : (unsigned char)*p;
+            p++;
+        }
+        if (hi < lo) {
+            mError = "reversed range in class";
+            return false;
+        }
+        for (int c = lo; c <= hi; c++) set[c] = true;
+    }
+    if (*p != ']') {
+        mError = "unterminated class";
+        return false;
+    }
+    p++;
+    if (negate) {
+        for (int c = 0; c < 256; c++) set[c] = !set[c];
+    }
+    return true;
+}
+
+//one byte, class or group with its repetitions, as a fragment begin -> end
+bool ScannerTable::parseAtom(const char *&p, int &begin, int &end) {
+    if (*p == '(') {
+        p++;
+        if (!parseAlt(p, begin, end)) return false;
+        if (*p != ')') {
+            mError = "missing )";
+            return false;
+        }
+        p++;
+    } else {
+        begin = state();
+        end = state();
+        mNfa[begin].next = end;
+        bool *set = mNfa[begin].set;
+        if (*p == '[') {
+            p++;
+            if (!parseClass(p, set)) return false;
+        } else if (*p == '.') {
+            p++;
+            for (int c = 0; c < 256; c++) set[c] = c != '\n';
+        } else if (*p == '\\' && p[1]) {
+            set[escaped(p[1])] = true;
+            p += 2;
+        } else if (*p && !strchr(")|*+?", *p)) {
+            set[(unsigned char)*p++] = true;
+        } else {
+            mError = string("unexpected ") + (*p ? string(1, *p) : "end of pattern");
+            return false;
+        }
+    }
+    while (*p == '*' || *p == '+' || *p == '?') {
+        int b = state();
+        int e = state();
+        mNfa[b].eps.push_back(begin);
+        mNfa[end].eps.push_back(e);
+        if (*p != '+') mNfa[b].eps.push_back(e);
+        if (*p != '?') mNfa[end].eps.push_back(begin);
+        begin = b;
+        end = e;
+        p++;
+    }
+    return true;
+}
+
+bool ScannerTable::parseSeq(const char *&p, int &begin, int &end) {
+    begin = end = state();
+    while (*p && *p != '|' && *p != ')') {
+        int b, e;
+        if (!parseAtom(p, b, e)) return false;
+        mNfa[end].eps.push_back(b);
+        end = e;
+    }
+    return true;
+}
+
+bool ScannerTable::parseAlt(const char *&p, int &begin, int &end) {
+    int b, e;
+    if (!parseSeq(p, b, e)) return false;
+    if (*p != '|') {
+        begin = b;
+        end = e;
+        return true;
+    }
+    begin = state();
+    end = state();
+    mNfa[begin].eps.push_back(b);
+    mNfa[e].eps.push_back(end);
+    while (*p == '|') {
+        p++;
+        if (!parseSeq(p, b, e)) return false;
+        mNfa[begin].eps.push_back(b);
+        mNfa[e].eps.push_back(end);
+    }
+    return true;
+}
+
+bool ScannerTable::add(const char *pattern, int id) {
+    size_t mark = mNfa.size();
+    const char *p = pattern;
+    mError.clear();
+    int begin, end;
+    if (!parseAlt(p, begin, end) || *p) {
+        if (mError.empty()) mError = "unbalanced )";
+        mError = string(pattern) + ": " + mError;
+        mNfa.resize(mark);
+        return false;
+    }
+    mNfa[end].def = mIds.size();
+    mStarts.push_back(begin);
+    mIds.push_back(id);
+    return true;
+}
+
+const string &ScannerTable::error() {
+    return mError;
+}
+
+/*************************************************************
+ *                      DFA
+*************************************************************/
+//sorted epsilon closure of states
+void ScannerTable::closure(vector<int> &states) {
+    vector<bool> seen(mNfa.size(), false);
+    vector<int> work(states);
+    states.clear();
+    while (!work.empty()) {
+        int s = work.back();
+        work.pop_back();
+        if (seen[s]) continue;
+        seen[s] = true;
+        states.push_back(s);
+        for (int i = 0; i < mNfa[s].eps.size(); i++) work.push_back(mNfa[s].eps[i]);
+    }
+    sort(states.begin(), states.end());
+}
+
+/*
+ * Subset construction over byte classes, then Moore's partition
+ * refinement: states start out split by the token they accept and are
+ * split again by the blocks their transitions lead to until nothing
+ * changes.
+ */
+void ScannerTable::build() {
+    //bytes on the same side of every edge share a class
+    map<vector<bool>, int> signatures;
+    for (int c = 0; c < 256; c++) {
+        vector<bool> sig;
+        for (int s = 0; s < mNfa.size(); s++) {
+            if (mNfa[s].next >= 0) sig.push_back(mNfa[s].set[c]);
+        }
+        auto found = signatures.find(sig);
+        if (found == signatures.end()) found = signatures.insert(make_pair(sig, (int)signatures.size())).first;
+        mClassOf[c] = found->second;
+    }
+    mClasses = signatures.size();
+    vector<int> sample(mClasses);
+    for (int c = 255; c >= 0; c--) sample[mClassOf[c]] = c;
+
+    //subsets
+    vector<vector<int>> subsets;
+    map<vector<int>, int> index;
+    vector<int> next;
+    vector<int> accept;
+    vector<int> start(mStarts);
+    closure(start);
+    subsets.push_back(start);
+    index[start] = 0;
+    for (int d = 0; d < subsets.size(); d++) {
+        int def = -1;
+        for (int i = 0; i < subsets[d].size(); i++) {
+            int s = mNfa[subsets[d][i]].def;
+            if (s >= 0 && (def < 0 || s < def)) def = s;
+        }
+        accept.push_back(def < 0 ? SCAN_ERROR : mIds[def]);
+        for (int k = 0; k < mClasses; k++) {
+            vector<int> move;
+            for (int i = 0; i < subsets[d].size(); i++) {
+                const NfaState &s = mNfa[subsets[d][i]];
+                if (s.next >= 0 && s.set[sample[k]]) move.push_back(s.next);
+            }
+            if (move.empty()) {
+                next.push_back(-1);
+                continue;
+            }
+            closure(move);
+            auto found = index.find(move);
+            if (found == index.end()) {
+                found = index.insert(make_pair(move, (int)subsets.size())).first;
+                subsets.push_back(move);
+            }
+            next.push_back(found->second);
+        }
+    }
+
+    //minimization, -1 stays the dead block
+    int n = subsets.size();
+    vector<int> block(n);
+    map<int, int> byAccept;
+    for (int d = 0; d < n; d++) {
+        auto found = byAccept.insert(make_pair(accept[d], (int)byAccept.size())).first;
+        block[d] = found->second;
+    }
+    int blocks = byAccept.size();
+    while (1) {
+        map<vector<int>, int> split;
+        vector<int> refined(n);
+        for (int d = 0; d < n; d++) {
+            vector<int> sig(1, block[d]);
+            for (int k = 0; k < mClasses; k++) {
+                int t = next[d * mClasses + k];
+                sig.push_back(t < 0 ? -1 : block[t]);
+            }
+            auto found = split.insert(make_pair(sig, (int)split.size())).first;
+            refined[d] = found->second;
+        }
+        block.swap(refined);
+        if (split.size() == blocks) break;
+        blocks = split.size();
+    }
+
+    //renumber blocks in order of first state, so the start stays 0
+    vector<int> number(blocks, -1);
+    int states = 0;
+    for (int d = 0; d < n; d++) {
+        if (number[block[d]] < 0) number[block[d]] = states++;
+    }
+    mNext.assign(states * mClasses, -1);
+    mAccept.assign(states, SCAN_ERROR);
+    for (int d = 0; d < n; d++) {
+        int s = number[block[d]];
+        mAccept[s] = accept[d];
+        for (int k = 0; k < mClasses; k++) {
+            int t = next[d * mClasses + k];
+            mNext[s * mClasses + k] = t < 0 ? -1 : number[block[t]];
+        }
+    }
+}
+
+int ScannerTable::states() const {
+    return mAccept.size();
+}
+
+int ScannerTable::classes() const {
+    return mClasses;
+}
+
+/*************************************************************
+ *                      Scanner
+*************************************************************/
+Scanner::Scanner(const ScannerTable &table, const char *data, size_t size) : mTable(table) {
+    mData = data;
+    mSize = size;
+    mPos = 0;
+}
+
+//longest match from the current position, one byte long when nothing matches
+Token Scanner::next() {
+    while (1) {
+        Token tok;
+        tok.offset = mPos;
+        if (mPos == mSize) {
+            tok.id = SCAN_END;
+            tok.length = 0;
+            return tok;
+        }
+        tok.id = SCAN_ERROR;
+        tok.length = 1;
+        int state = 0;
+        for (size_t i = mPos; i < mSize; i++) {
+            state = mTable.next(state, mData[i]);
+            if (state < 0) break;
+            if (mTable.accept(state) == SCAN_ERROR) continue;
+            tok.id = mTable.accept(state);
+            tok.length = i+1 - mPos;
+        }
+        mPos += tok.length;
+        if (tok.id != SCAN_SKIP) return tok;
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef SCANNER_HPP
+#define SCANNER_HPP
+
+#include "engine.hpp"
+#include <string>
+#include <functional>
+
+#define SCAN_END   -1   //id of the token after the last one
+#define SCAN_ERROR -2   //id of a byte no definition matches
+#define SCAN_SKIP  -3   //id of definitions whose matches are dropped, e.g. blanks
+
+struct Token {
+    int id;
+    size_t offset;
+    size_t length;
+};
+
+/*
+ * Token definitions compiled into a minimized DFA. Patterns are regular
+ * expressions over bytes:
+ *
+ *   x  \x      the byte, escaped when special; \n \t \r \0 are control bytes
+ *   .          any byte but \n
+ *   [a-z_]     a class of bytes and ranges, [^...] its complement
+ *   ( ) | * + ?
+ *
+ * The longest match wins and of equally long ones the earliest definition.
+ * Bytes no pattern tells apart share one column of the transition table.
+ */
+class ScannerTable {
+private:
+    struct NfaState {
+        vector<int> eps;
+        bool set[256];      //bytes of the edge to next
+        int next;
+        int def;            //definition accepted here, or -1
+    };
+    vector<NfaState> mNfa;
+    vector<int> mStarts;        //nfa start of every definition
+    vector<int> mIds;           //definition -> token id
+    string mError;
+    //the dfa, state 0 starts
+    int mClasses;
+    unsigned char mClassOf[256];
+    vector<int> mNext;          //[state * classes + class], -1 for none
+    vector<int> mAccept;        //state -> token id, or SCAN_ERROR when it accepts nothing
+
+    int state();
+    bool parseAlt(const char *&p, int &begin, int &end);
+    bool parseSeq(const char *&p, int &begin, int &end);
+    bool parseAtom(const char *&p, int &begin, int &end);
+    bool parseClass(const char *&p, bool *set);
+    void closure(vector<int> &states);
+public:
+    ScannerTable();
+    //false with error() set when the pattern does not parse
+    bool add(const char *pattern, int id);
+    //compiles the definitions added so far
+    void build();
+    const string &error();
+    int states() const;
+    int classes() const;
+    int next(int state, unsigned char c) const {
+        return mNext[state * mClasses + mClassOf[c]];
+    }
+    int accept(int state) const {
+        return mAccept[state];
+    }
+};
+
+//tokens of a span of bytes owned by the caller, skipped definitions dropped
+class Scanner {
+private:
+    const ScannerTable &mTable;
+    const char *mData;
+    size_t mSize;
+    size_t mPos;
+public:
+    Scanner(const ScannerTable &table, const char *data, size_t size);
+    Token next();
+};
+
+/*
+ * Runs the tokens of scanner through engine, columns maps token ids to
+ * table columns and value makes the semantic value of a token. Returns
+ * the engine status; a byte no token matches or a token without a column
+ * is a PARSE_ERROR, with the token in bad, input that ends too early fails
+ * with the SCAN_END token.
+ */
+template <class V>
+int feedTokens(Scanner &scanner, Engine<V> &engine, const vector<int> &columns,
+    const function<V(const Token &)> &value, Token *bad = NULL) {
+    while (1) {
+        Token tok = scanner.next();
+        if (tok.id == SCAN_END) {
+            int status = engine.finish();
+            if (status != PARSE_DONE && bad) *bad = tok;
+            return status;
+        }
+        int column = tok.id >= 0 && tok.id < columns.size() ? columns[tok.id] : -1;
+        if (column < 0 || engine.feed(column, value(tok)) == PARSE_ERROR) {
+            if (bad) *bad = tok;
+            return PARSE_ERROR;
+        }
+        if (engine.status() == PARSE_DONE) return PARSE_DONE;
+    }
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "syntaxparser.hpp"
-#include <deque>
+#include "packedtable.hpp"
+#include "digits.hpp"
 #include <map>
 #include <stdlib.h>
 
@@ -32,7 +33,7 @@ void panic(const char *str) {
 11                      r2  |
 12                  r3  r3  |
 13  r7          r7  r7  r7  |
-14                  r4      |
+14                  r4  r4  |
 
 */
 action lalrtable[15][10] = {
@@ -50,7 +51,7 @@ action lalrtable[15][10] = {
     {NA,    NA,     NA,     NA,     R(2),   NA,     NA,     NA,     NA,     NA},
     {NA,    NA,     NA,     R(3),   R(3),   NA,     NA,     NA,     NA,     NA},
     {R(7),  NA,     R(7),   R(7),   R(7),   NA,     NA,     NA,     NA,     NA},
-    {NA,    NA,     NA,     R(4),   NA,     NA,     NA,     NA,     NA,     NA}
+    {NA,    NA,     NA,     R(4),   R(4),   NA,     NA,     NA,     NA,     NA}
 };
 
 typedef struct stackblk {
@@ -66,198 +67,161 @@ typedef struct stackblk {
     } u;
 } stackblk;
 
-File *newFile(Line *line, File *next) {
-    File *file = (File *)malloc(sizeof(File));
-    file->line = line;
-    file->next = next;
-    return file;
-}
-
-Exp *newExp(Id *id, Exp *next) {
-    Exp *exp = (Exp *)malloc(sizeof(Exp));
-    exp->id = id;
-    exp->next = next;
-    return exp;
-}
-
-Line *newLine(Id *id, Exp *exp) {
-
-    Line *line = (Line *)malloc(sizeof(Line));
-    line->exp = exp;
-    line->id = id;
-    return line;
-}
-
-Id *newId(Digits *digits) {
-    Id *id = (Id *)malloc(sizeof(Id));
-    id->digits = digits;
-    return id;
-}
-
-Digits *newDigits(int val, Digits *next) {
-    Digits *digits = (Digits *)malloc(sizeof(Digits));
-    digits->next = next;
-    digits->val = val;
-    return digits;
-}
-
-stackblk makeStackBlk(int type, int state, void *data) {
-    stackblk blk;
-    blk.state = state;
-    blk.type = type;
-    switch (type)
-    {
-    case F:
-        blk.u.file = (File *)data;
-        break;
-    case L:
-        blk.u.line = (Line *)data;
-        break;
-    case I:
-        blk.u.id =  (Id *)data;
-        break;
-    case D:
-        blk.u.digits = (Digits *)data;
-        break;
-    case E:
-        blk.u.exp = (Exp *)data;
-    default:
-        blk.u.c = (u_int64_t)data;
-        break;
+//contiguous parse stack, doubles when full
+struct ParseStack {
+    stackblk *blks;
+    int size;
+    int cap;
+    ParseStack(int cap = 64): size(0), cap(cap) {
+        blks = (stackblk *)malloc(cap * sizeof(stackblk));
     }
-    return blk;
-}
-
-map<int, int> getMap() {
-    map<int, int> res;
-    res['/'] = 0;
-    res['0'] = 1;
-    res['1'] = 1;
-    res['2'] = 1;
-    res['3'] = 1;
-    res['4'] = 1;
-    res['5'] = 1;
-    res['6'] = 1;
-    res['7'] = 1;
-    res['8'] = 1;
-    res['9'] = 1;
-    res['>'] = 2;
-    res['\n'] = 3;
-    res[EOF] = 4;
-    res[F] = 5;
-    res[L] = 6;
-    res[E] = 7;
-    res[I] = 8;
-    res[D] = 9;
-    return res;
+    ~ParseStack() {
+        free(blks);
+    }
+    stackblk *push(int type) {
+        if (size == cap) blks = (stackblk *)realloc(blks, (cap *= 2) * sizeof(stackblk));
+        blks[size].type = type;
+        return &blks[size++];
+    }
+    //drops the top n blocks, they stay readable until the next push
+    stackblk *pop(int n) {
+        size -= n;
+        return &blks[size];
+    }
+    stackblk *top() {
+        return &blks[size-1];
+    }
+};
+
+File *newFile(Arena &arena, Line *line, File *next) {
+    return arena.make<File>(line, next);
 }
 
+Exp *newExp(Arena &arena, Id *id, Exp *next) {
+    return arena.make<Exp>(id, next);
+}
 
-typedef auto (*reduce_fun)(deque<stackblk> &) -> stackblk;
+Line *newLine(Arena &arena, Id *id, Exp *exp) {
+    return arena.make<Line>(exp, id);
+}
 
+Id *newId(Arena &arena, Digits *digits) {
+    return arena.make<Id>(digits);
+}
 
-stackblk r1(deque<stackblk> &stack) {
-    auto line = stack.back().u.line;
-    if (stack.back().type != L) panic("r1");
-    stack.pop_back();
-    stackblk res;
-    res.type = F;
-    res.u.file = newFile(line, NULL);
-    return res;
+Digits *newDigits(Arena &arena, int val, Digits *next) {
+    return arena.make<Digits>(val, next);
 }
 
-stackblk r2(deque<stackblk> &stack) {
-    auto next = stack.back().u.file;
-    if (stack.back().type != F) panic("r2.1");
-    stack.pop_back(); 
-    stack.pop_back();
-    auto line = stack.back().u.line;
-    if (stack.back().type != L) panic("r2.2");
-    stack.pop_back();
-    stackblk res;
-    res.type = F;
-    res.u.file = newFile(line, next);
-    return res;
+//input bytes and EOF, then the nonterminals, mapped to table columns
+#define INPUT_CODES 257
+#define EOF_CODE 256
+#define NONTERMINALS (D-OFFSET+1)
+#define HAND_COLUMNS 10
+
+struct Columns {
+    int input[INPUT_CODES];
+    int nonterminal[NONTERMINALS];
+};
+
+static inline int inputCode(int c) {
+    return c == EOF ? EOF_CODE : (unsigned char)c;
 }
 
-stackblk r3(deque<stackblk> &stack) {
-    auto exp = stack.back().u.exp;
-    if (stack.back().type != E) panic("r3.1");
-    stack.pop_back(); 
-    stack.pop_back();
-    auto id = stack.back().u.id;
-    if (stack.back().type != I) panic("r3.2");
-    stack.pop_back();
-    stackblk res;
-    res.type = L;
-    res.u.line = newLine(id, exp);
+//columns of the hand written table, they double as the ids of syntax.lr
+static const Columns &handColumns() {
+    static Columns res = [] {
+        Columns cols;
+        for (int i = 0; i < INPUT_CODES; i++) cols.input[i] = -1;
+        cols.input['/'] = 0;
+        for (int c = '0'; c <= '9'; c++) cols.input[c] = 1;
+        cols.input['>'] = 2;
+        cols.input['\n'] = 3;
+        cols.input[EOF_CODE] = 4;
+        cols.nonterminal[F-OFFSET] = 5;
+        cols.nonterminal[L-OFFSET] = 6;
+        cols.nonterminal[E-OFFSET] = 7;
+        cols.nonterminal[I-OFFSET] = 8;
+        cols.nonterminal[D-OFFSET] = 9;
+        return cols;
+    }();
     return res;
 }
 
-stackblk r4(deque<stackblk> &stack) {
-    auto exp = stack.back().u.exp;
-    if (stack.back().type != E) panic("r4.1");
-    stack.pop_back();
-    auto id = stack.back().u.id;
-    if (stack.back().type != I) panic("r4.2");
-    stack.pop_back();
-    stackblk res;
-    res.type = E;
-    res.u.exp = newExp(id, exp);
-    return res;
+
+typedef void (*reduce_fun)(ParseStack &, Arena &);
+
+/*
+ * Reductions pop their right hand side and push the left hand side in its
+ * place, the goto that follows fills in the state.
+ */
+void r1(ParseStack &stack, Arena &arena) {
+    stackblk *rhs = stack.pop(1);
+    if (rhs[0].type != L) panic("r1");
+    File *file = newFile(arena, rhs[0].u.line, NULL);
+    stack.push(F)->u.file = file;
+}
+
+void r2(ParseStack &stack, Arena &arena) {
+    stackblk *rhs = stack.pop(3);
+    if (rhs[2].type != F) panic("r2.1");
+    if (rhs[0].type != L) panic("r2.2");
+    File *file = newFile(arena, rhs[0].u.line, rhs[2].u.file);
+    stack.push(F)->u.file = file;
 }
 
+void r3(ParseStack &stack, Arena &arena) {
+    stackblk *rhs = stack.pop(3);
+    if (rhs[2].type != E) panic("r3.1");
+    if (rhs[0].type != I) panic("r3.2");
+    Line *line = newLine(arena, rhs[0].u.id, rhs[2].u.exp);
+    stack.push(L)->u.line = line;
+}
 
-stackblk r5(deque<stackblk> &stack) {
-    auto id = stack.back().u.id;
-    if (stack.back().type != I) panic("r5");
-    stack.pop_back(); 
-    stackblk res;
-    res.type = E;
-    res.u.exp = newExp(id, NULL);
-    return res;
+void r4(ParseStack &stack, Arena &arena) {
+    stackblk *rhs = stack.pop(2);
+    if (rhs[1].type != E) panic("r4.1");
+    if (rhs[0].type != I) panic("r4.2");
+    Exp *exp = newExp(arena, rhs[0].u.id, rhs[1].u.exp);
+    stack.push(E)->u.exp = exp;
 }
 
 
-stackblk r6(deque<stackblk> &stack) {
-    auto digits = stack.back().u.digits;
-    if (stack.back().type != D) panic("r6");
-    stack.pop_back(); 
-    stack.pop_back();
-    stackblk res;
-    res.type = I;
-    res.u.id = newId(digits);
-    return res;
+void r5(ParseStack &stack, Arena &arena) {
+    stackblk *rhs = stack.pop(1);
+    if (rhs[0].type != I) panic("r5");
+    Exp *exp = newExp(arena, rhs[0].u.id, NULL);
+    stack.push(E)->u.exp = exp;
 }
 
-stackblk r7(deque<stackblk> &stack) {
-    auto digits = stack.back().u.digits;
-    if (stack.back().type != D) panic("r7");
-    stack.pop_back(); 
-    auto c = stack.back().u.c;
-    stack.pop_back();
-    stackblk res;
-    res.type = D;
-    res.u.digits = newDigits(c, digits);
-    return res;
+
+void r6(ParseStack &stack, Arena &arena) {
+    stackblk *rhs = stack.pop(2);
+    if (rhs[1].type != D) panic("r6");
+    Id *id = newId(arena, rhs[1].u.digits);
+    stack.push(I)->u.id = id;
 }
 
+void r7(ParseStack &stack, Arena &arena) {
+    stackblk *rhs = stack.pop(2);
+    if (rhs[1].type != D) panic("r7");
+    Digits *digits = newDigits(arena, rhs[0].u.c, rhs[1].u.digits);
+    stack.push(D)->u.digits = digits;
+}
 
-stackblk r8(deque<stackblk> &stack) {
-    auto c = *(char *)((u_int64_t *)(&stack.back().u.c));
-    // printf("reduce digit: %c\n", c);
-    stack.pop_back(); 
-    stackblk res;
-    res.type = D;
-    res.u.digits = newDigits(c, NULL);
-    return res;
+
+void r8(ParseStack &stack, Arena &arena) {
+    stackblk *rhs = stack.pop(1);
+    // printf("reduce digit: %c\n", (char)rhs[0].u.c);
+    Digits *digits = newDigits(arena, (char)rhs[0].u.c, NULL);
+    stack.push(D)->u.digits = digits;
 }
 
-stackblk r0(deque<stackblk> &stack) {
+void r0(ParseStack &stack, Arena &) {
     printf("accepted\n");
-    auto entry = stack.front();
-    stack.pop_back();
-    return entry;
+    stackblk entry = stack.blks[0];
+    stack.pop(1);
+    *stack.push(entry.type) = entry;
 }
 reduce_fun reduce[NUM_RULES] = {
     r0,
@@ -270,92 +234,339 @@ reduce_fun reduce[NUM_RULES] = {
     r7,
     r8
 };
+#define DIGIT_RULE 8    //D -> [0-9], r7 folds the rest of a run onto it
+
+/*
+ * One parse in progress: the stack, the state on top of it and how the
+ * last input went. take() moves one input code all the way to its shift,
+ * taking every reduction on the way. Default reductions are taken as soon
+ * as their state is reached, they need no lookahead.
+ *
+ * A syntax error is recorded as a Diagnostic. Without recovery the parse
+ * stops there. With recovery input is dropped up to the next sync code,
+ * then the stack is popped until a state takes that code, so the parse
+ * resumes after the broken part and reports every error in one pass. EOF
+ * always syncs; a sync code no state takes is dropped from the start
+ * state.
+ *
+ * feed() takes a run of digits whole when the state before it shifts
+ * digits into a state that shifts them to itself: the Digits list is
+ * built at once and pushed as the D the per digit shifts and reductions
+ * would have left, provided the byte after the run reduces by DIGIT_RULE.
+ * Anything else, e.g. a run cut by the end of the chunk, goes byte by byte.
+ */
+struct ParseRun {
+    Arena &arena;
+    const PackedTable &table;
+    Columns columns;
+    ParseStack stack;
+    int start;
+    int state;
+    int status;
+    int entry;      //input code or nonterminal the last step failed on
+    size_t offset;  //input bytes taken
+    bool recover;
+    bool sync[INPUT_CODES];
+    bool skipping;  //dropping input up to the next sync code
+    vector<Diagnostic> diagnostics;
+    vector<int> digitShift;     //state -> state a digit run stays in, or -1
+    vector<int> digitGoto;      //state -> its goto on D
+
+    ParseRun(Arena &arena, const PackedTable &table, const Columns &columns, int start)
+        : arena(arena), table(table), columns(columns), start(start), recover(false) {
+        for (int i = 0; i < INPUT_CODES; i++) sync[i] = false;
+        sync[EOF_CODE] = true;
+        findDigitRuns();
+        reset();
+    }
+
+    void findDigitRuns() {
+        int states = table.states();
+        digitShift.assign(states, -1);
+        digitGoto.assign(states, -1);
+        int digit = columns.input['0'];
+        int d = columns.nonterminal[D-OFFSET];
+        for (int c = '1'; c <= '9'; c++) {
+            if (columns.input[c] != digit) return;
+        }
+        if (digit < 0 || d < 0) return;
+        for (int s = 0; s < states; s++) {
+            if (table.defaultReduce(s) >= 0) continue;
+            action shift = table.lookup(s, digit);
+            action go = table.lookup(s, d);
+            if (shift.type != SHIFT || shift.num == s || go.type != GOTO) continue;
+            int t = shift.num;
+            action loop = table.lookup(t, digit);
+            if (table.defaultReduce(t) >= 0 || loop.type != SHIFT || loop.num != t) continue;
+            digitShift[s] = t;
+            digitGoto[s] = go.num;
+        }
+    }
+
+    //back to the start state, keeping the stack memory and the sync codes
+    void reset() {
+        stack.size = 0;
+        state = start;
+        status = settle() ? PARSE_MORE : PARSE_ERROR;
+        entry = 0;
+        offset = 0;
+        skipping = false;
+        diagnostics.clear();
+    }
+
+    //reduces by rule and takes the goto on its left hand side
+    bool reduceBy(int rule) {
+        if (rule < 0 || rule >= NUM_RULES) panic("parse: no reduction for the table's rule");
+        reduce[rule](stack, arena);
+        state = stack.size > 1 ? stack.blks[stack.size-2].state : start;
+        int next = stack.top()->type;
+        int column = columns.nonterminal[next-OFFSET];
+        action act = column >= 0 ? table.lookup(state, column) : NA;
+        if (act.type != GOTO) {
+            entry = next;
+            return false;
+        }
+        state = act.num;
+        stack.top()->state = state;
+        return true;
+    }
+
+    bool settle() {
+        int rule;
+        while ((rule = table.defaultReduce(state)) >= 0) {
+            if (!reduceBy(rule)) return false;
+        }
+        return true;
+    }
+
+    //moves c to its shift or the accept, false when the table has no way
+    bool step(int c) {
+        int column = columns.input[inputCode(c)];
+        while (1) {
+            action act = column >= 0 ? table.lookup(state, column) : NA;
+            switch (act.type)
+            {
+            case SHIFT: {
+                state = act.num;
+                stackblk *blk = stack.push(c);
+                blk->state = state;
+                blk->u.c = c;
+                return settle();
+            }
+            case REDUCE:
+                if (!reduceBy(act.num) || !settle()) return false;
+                break;
+            case ACCEPT:
+                status = PARSE_DONE;
+                return true;
+            default:
+                entry = c;
+                return false;
+            }
+        }
+    }
+
+    //pops the stack until a state takes the sync code c
+    void resync(int c) {
+        int column = columns.input[inputCode(c)];
+        while (1) {
+            if (column >= 0 && table.lookup(state, column).type != FAIL && step(c)) return;
+            if (stack.size == 0) break;
+            stack.size--;
+            state = stack.size ? stack.top()->state : start;
+        }
+        if (c == EOF) status = PARSE_ERROR;
+    }
+
+    int take(int c) {
+        if (status != PARSE_MORE) return status;
+        if (c != EOF) offset++;
+        bool isSync = sync[inputCode(c)];
+        if (skipping && !isSync) return status;
+        if (!skipping) {
+            if (step(c)) return status;
+            Diagnostic diag = {state, entry, c == EOF ? offset : offset-1};
+            diagnostics.push_back(diag);
+            //a missing goto is a broken table, nothing to recover from
+            if (!recover || entry >= OFFSET) return status = PARSE_ERROR;
+            skipping = !isSync;
+            if (skipping) return status;
+        }
+        skipping = false;
+        resync(c);
+        return status;
+    }
+
+    //the n digits at p as one D, false when next would not end the run by DIGIT_RULE
+    bool takeDigits(const char *p, size_t n, int next) {
+        int column = columns.input[inputCode(next)];
+        action act = column >= 0 ? table.lookup(digitShift[state], column) : NA;
+        if (act.type != REDUCE || act.num != DIGIT_RULE) return false;
+        Digits *digits = NULL;
+        for (size_t i = n; i-- > 0;) digits = newDigits(arena, p[i], digits);
+        state = digitGoto[state];
+        stackblk *blk = stack.push(D);
+        blk->state = state;
+        blk->u.digits = digits;
+        offset += n;
+        if (!settle()) status = PARSE_ERROR;
+        return true;
+    }
 
-File *parse(Reader *reader) {
-    int state = 1;
-    deque<stackblk> stack;
-    stackblk buffer;
-    int c = reader->getc();
-    int next = c;
-    map<int, int> dict = getMap();
-    // printf("State g%d\n", state);
-    // printf("%c\n", *(char *)((int *)(&next)));
-    while (1) {
-        action act = lalrtable[state][dict[next]];
-        switch (act.type)
-        {
-        case FAIL:
-            printf("Syntax error on state %d, with entry %d\n", state, next);
-            exit(-1);
-        case SHIFT:
-            state = act.num;
-            stack.push_back(makeStackBlk(next, state, (void *)next));
-            c = reader->getc();
-            next = c;
-            // printf("State s%d\n", state);
-            // printf("%c\n", *(char *)((int *)(&next)));
-            break;
-        case GOTO:
-            state = act.num;
-            buffer.state = state;
-            stack.push_back(buffer);
-            next = c;
-            // printf("State g%d\n", state);
-            break;
-        case REDUCE:
-            buffer = reduce[act.num](stack);
-            next = buffer.type;
-            state = !stack.empty() ? stack.back().state : 1;
-            // printf("State r%d, to state %d\n", act.num, state);
-            break;
-        case ACCEPT:
-            printf("finish stack size: %d\n", stack.size());
-            return stack.back().u.file;
-        default:
-            break;
+    //takes bytes of data until the parse is decided, returns how many
+    size_t feed(const char *data, size_t size) {
+        size_t i = 0;
+        while (i < size && status == PARSE_MORE) {
+            if (digitShift[state] >= 0 && !skipping) {
+                size_t n = digitRun(data+i, size-i);
+                if (n && i+n < size && takeDigits(data+i, n, (unsigned char)data[i+n])) {
+                    i += n;
+                    continue;
+                }
+            }
+            take((unsigned char)data[i++]);
         }
+        return i;
     }
-    return NULL;
-}
-
-File *parse(Reader *reader, vector<vector<action>> lrtable, map<int, int> mapping) {
-    int state = 0;
-    deque<stackblk> stack;
-    stackblk buffer;
-    int c = reader->getc();
-    int next = c;
-    map<int, int> dict = getMap();
-    while (1) {
-        action act = lrtable[state][mapping[dict[next]]];
-        switch (act.type)
-        {
-        case FAIL:
-            printf("Syntax error on state %d, with entry %d\n", state, next);
-            exit(-1);
-        case SHIFT:
-            state = act.num;
-            stack.push_back(makeStackBlk(next, state, (void *)next));
-            c = reader->getc();
-            next = c;
-            break;
-        case GOTO:
-            state = act.num;
-            buffer.state = state;
-            stack.push_back(buffer);
-            next = c;
-            break;
-        case REDUCE:
-            buffer = reduce[act.num](stack);
-            next = buffer.type;
-            state = !stack.empty() ? stack.back().state : 0;
-            break;
-        case ACCEPT:
-            return stack.front().u.file;
-        default:
-            break;
+
+    File *result() {
+        return status == PARSE_DONE ? stack.blks[0].u.file : NULL;
+    }
+};
+
+/*
+ * Pulls input from reader until the parse is decided. Errors are
+ * recovered at line ends and collected into diagnostics when given,
+ * otherwise the first one ends the process.
+ */
+static File *run(Reader *reader, ParseRun &run, int &depth, vector<Diagnostic> *diagnostics) {
+    if (diagnostics) {
+        run.recover = true;
+        run.sync['\n'] = true;
+    }
+    while (run.status == PARSE_MORE) {
+        size_t size;
+        const char *data = reader->window(size);
+        if (size) {
+            reader->skip(run.feed(data, size));
+        } else {
+            run.take(EOF);
         }
     }
-    return NULL;
+    if (diagnostics) {
+        *diagnostics = run.diagnostics;
+    } else if (run.status == PARSE_ERROR) {
+        printf("Syntax error on state %d, with entry %d\n", run.diagnostics[0].state, run.diagnostics[0].entry);
+        exit(-1);
+    }
+    depth = run.stack.size;
+    return run.result();
+}
+
+static vector<vector<action>> handTable() {
+    vector<vector<action>> res;
+    for (int i = 0; i < 15; i++) {
+        res.push_back(vector<action>(lalrtable[i], lalrtable[i]+10));
+    }
+    return res;
+}
+
+static const PackedTable &handPacked() {
+    static PackedTable table(handTable(), 5);
+    return table;
+}
+
+//looks ids up in mapping, which must outlive the result
+static ColumnOf columnIn(const map<int, int> &mapping) {
+    return [&mapping](int id) {
+        auto col = mapping.find(id);
+        return col != mapping.end() ? col->second : -1;
+    };
+}
+
+//hand columns are the ids of the grammar, look each one up once
+static Columns mappedColumns(const ColumnOf &column) {
+    const Columns &hand = handColumns();
+    int remap[HAND_COLUMNS];
+    for (int i = 0; i < HAND_COLUMNS; i++) remap[i] = column(i);
+    Columns columns;
+    for (int i = 0; i < INPUT_CODES; i++) columns.input[i] = hand.input[i] >= 0 ? remap[hand.input[i]] : -1;
+    for (int i = 0; i < NONTERMINALS; i++) columns.nonterminal[i] = remap[hand.nonterminal[i]];
+    return columns;
+}
+
+File *parse(Reader *reader, Arena &arena, vector<Diagnostic> *diagnostics) {
+    ParseRun parser(arena, handPacked(), handColumns(), 1);
+    int depth;
+    File *res = run(reader, parser, depth, diagnostics);
+    printf("finish stack size: %d\n", depth);
+    return res;
+}
+
+File *parse(Reader *reader, Arena &arena, const vector<vector<action>> &lrtable, const map<int, int> &mapping,
+    const vector<int> &defaults, vector<Diagnostic> *diagnostics) {
+    return parse(reader, arena, PackedTable(lrtable, -1, defaults), mapping, diagnostics);
+}
+
+File *parse(Reader *reader, Arena &arena, const PackedTable &lrtable, const map<int, int> &mapping, vector<Diagnostic> *diagnostics) {
+    return parse(reader, arena, lrtable, columnIn(mapping), diagnostics);
+}
+
+File *parse(Reader *reader, Arena &arena, const PackedTable &lrtable, const ColumnOf &column, vector<Diagnostic> *diagnostics) {
+    ParseRun parser(arena, lrtable, mappedColumns(column), 0);
+    int depth;
+    return run(reader, parser, depth, diagnostics);
+}
+
+/*************************************************************
+ *                      PushParser
+*************************************************************/
+PushParser::PushParser(Arena &arena) {
+    mRun = new ParseRun(arena, handPacked(), handColumns(), 1);
+}
+
+PushParser::PushParser(Arena &arena, const PackedTable &table, const map<int, int> &mapping) {
+    mRun = new ParseRun(arena, table, mappedColumns(columnIn(mapping)), 0);
+}
+
+PushParser::~PushParser() {
+    delete mRun;
+}
+
+int PushParser::feed(const char *data, size_t size) {
+    mRun->feed(data, size);
+    return mRun->status;
+}
+
+//the end of input may take more than one step, e.g. a shift of $ before the accept
+int PushParser::finish() {
+    while (mRun->take(EOF) == PARSE_MORE);
+    return mRun->status;
+}
+
+int PushParser::status() {
+    return mRun->status;
+}
+
+File *PushParser::result() {
+    return mRun->result();
+}
+
+void PushParser::reset() {
+    mRun->reset();
+}
+
+size_t PushParser::offset() {
+    return mRun->offset;
+}
+
+void PushParser::recoverAt(const char *sync) {
+    mRun->recover = true;
+    for (const char *c = sync; *c; c++) mRun->sync[(unsigned char)*c] = true;
+}
+
+const vector<Diagnostic> &PushParser::diagnostics() {
+    return mRun->diagnostics;
 }
 
 
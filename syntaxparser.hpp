@@ -2,8 +2,10 @@
 #define SYNTAX_PARSER_HPP
 
 #include "reader.hpp"
+#include "arena.hpp"
 #include <vector>
 #include <map>
+#include <functional>
 /*Grammar of how to define gramar
 
 F' -> .F&       ?                   r0
@@ -41,6 +43,8 @@ lalrtable:
 13  r7          r7  r7  r7  |
 14                  r4  r4  |
 
+States 10 to 14 only reduce, the parser takes those reductions without
+reading ahead.
 */
 #define NUM_RULES 9
 #define FAIL  0
@@ -62,6 +66,8 @@ typedef struct action {
 } action;
 
 action createAction(int a, int b);
+//prints str and exits, for states that mean a bug rather than bad input
+void panic(const char *str);
 
 typedef struct File     File;
 typedef struct Line     Line;
@@ -98,10 +104,74 @@ struct Digits
     Digits *next = NULL;
 };
 
-File *parse(Reader *reader);
-//test purpose
-File *parse(Reader *reader, vector<vector<action>> lrtable, map<int, int> mapping);
+class PackedTable;
+
+//a syntax error, the entry is an input byte, EOF, or a nonterminal code
+struct Diagnostic {
+    int state;
+    int entry;
+    size_t offset;      //of the entry in the input, its length for EOF
+};
+
+/*
+ * Nodes of the tree live in arena, the caller releases them with it.
+ * With diagnostics the parse recovers at line ends, collects every error
+ * there and returns what it could parse, NULL when even the recovery
+ * failed. Without, the first error prints a message and exits.
+ */
+File *parse(Reader *reader, Arena &arena, vector<Diagnostic> *diagnostics = NULL);
+//test purpose, the table must be generated from syntax.lr, other grammars go through Engine
+File *parse(Reader *reader, Arena &arena, const vector<vector<action>> &lrtable, const map<int, int> &mapping,
+    const vector<int> &defaults = vector<int>(), vector<Diagnostic> *diagnostics = NULL);
+File *parse(Reader *reader, Arena &arena, const PackedTable &lrtable, const map<int, int> &mapping,
+    vector<Diagnostic> *diagnostics = NULL);
+//column of a grammar id, -1 when the table has none
+typedef function<int(int id)> ColumnOf;
+File *parse(Reader *reader, Arena &arena, const PackedTable &lrtable, const ColumnOf &column,
+    vector<Diagnostic> *diagnostics = NULL);
 int id2int(Id *id);
 
+#define PARSE_MORE  0
+#define PARSE_DONE  1
+#define PARSE_ERROR 2
+
+struct ParseRun;
+
+/*
+ * Push form of parse() for input that arrives in pieces. feed() takes
+ * every byte as far as it goes, reductions included, so between calls only
+ * the parse stack is held. finish() marks the end of input. Both return
+ * PARSE_MORE while more input is welcome, PARSE_DONE once the input is
+ * accepted and PARSE_ERROR on a syntax error; later calls change nothing.
+ * After recoverAt() errors only end up in diagnostics(), the parse goes
+ * on from the next of the given bytes and PARSE_ERROR means it could not
+ * recover by the end of input.
+ */
+class PushParser {
+private:
+    ParseRun *mRun;
+public:
+    //the hand written table
+    PushParser(Arena &arena);
+    //table must outlive the parser
+    PushParser(Arena &arena, const PackedTable &table, const map<int, int> &mapping);
+    PushParser(const PushParser &) = delete;
+    PushParser &operator=(const PushParser &) = delete;
+    ~PushParser();
+    int feed(const char *data, size_t size);
+    int finish();
+    int status();
+    //tree after PARSE_DONE, NULL before
+    File *result();
+    //starts over on new input, the arena is left to the caller
+    void reset();
+    //input bytes taken, the failing one included after PARSE_ERROR
+    size_t offset();
+    //resynchronize on any byte of sync instead of stopping at the first error
+    void recoverAt(const char *sync);
+    //errors so far, in input order
+    const vector<Diagnostic> &diagnostics();
+};
+
 
 #endif
\ No newline at end of file
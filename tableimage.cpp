@@ -0,0 +1,237 @@
+#include "tableimage.hpp"
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*************************************************************
+ *                      WRITING
+*************************************************************/
+static uint64_t mix(uint64_t h, int64_t v) {
+    h ^= (uint64_t)v;
+    h *= 0x100000001b3ULL;
+    return h;
+}
+
+//content address of a grammar, independent of how its file was spelled
+uint64_t hashGrammar(File *file) {
+    uint64_t h = mix(0xcbf29ce484222325ULL, TABLE_IMAGE_VERSION);
+    for (File *i = file; i; i = i->next) {
+        h = mix(h, id2int(i->line->id));
+        for (Exp *exp = i->line->exp; exp; exp = exp->next) {
+            h = mix(h, id2int(exp->id));
+        }
+        h = mix(h, -1);
+    }
+    return h;
+}
+
+template <class T>
+static bool put(FILE *out, const T *data, size_t count) {
+    return fwrite(data, sizeof(T), count, out) == count;
+}
+
+bool writeTableImage(const char *path, LRTable &table, uint64_t hash) {
+    PackedTable packed(table.getTable(), table.getTerminals(), table.getDefaults());
+    const PackedArrays &t = packed.arrays();
+    const map<int, int> &mapping = table.getMapping();
+    const Rules &rules = table.getRules();
+    TableHeader header;
+    header.magic = TABLE_IMAGE_MAGIC;
+    header.version = TABLE_IMAGE_VERSION;
+    header.hash = hash;
+    header.states = t.states;
+    header.columns = t.columns;
+    header.terminals = t.terminals;
+    header.actionSize = t.actionSize;
+    header.gotoSize = t.gotoSize;
+    header.symbols = mapping.size();
+    header.rules = rules.size();
+    header.reserved = 0;
+    vector<int32_t> pairs;
+    for (auto it = mapping.begin(); it != mapping.end(); it++) {
+        pairs.push_back(it->first);
+        pairs.push_back(it->second);
+    }
+    vector<int32_t> meta;
+    for (int i = 0; i < rules.size(); i++) {
+        meta.push_back(table.getSymbols().id(rules[i]->getFrom()));
+        meta.push_back(rules[i]->getSize());
+    }
+    FILE *out = fopen(path, "wb");
+    if (!out) return false;
+    int gotos = t.columns - t.terminals;
+    bool ok = put(out, &header, 1)
+        && put(out, t.base, t.states) && put(out, t.defaultReduce, t.states)
+        && put(out, t.check, t.actionSize) && put(out, t.actions, t.actionSize)
+        && put(out, t.defaultGoto, gotos) && put(out, t.gotoBase, gotos)
+        && put(out, t.gotoCheck, t.gotoSize) && put(out, t.gotos, t.gotoSize)
+        && put(out, pairs.data(), pairs.size())
+        && put(out, meta.data(), meta.size());
+    return fclose(out) == 0 && ok;
+}
+
+/*************************************************************
+ *                      TableImage
+*************************************************************/
+static bool validAction(uint32_t packed, int states, int rules) {
+    switch (PACKED_TYPE(packed)) {
+    case FAIL:
+    case ACCEPT:
+        return true;
+    case SHIFT:
+    case GOTO:
+        return PACKED_NUM(packed) < states;
+    case REDUCE:
+        return PACKED_NUM(packed) < rules;
+    default:
+        return false;
+    }
+}
+
+/*
+ * Whether every lookup into the arrays stays inside them and lands on a
+ * state or rule that exists, so a damaged image is rejected instead of
+ * being read out of bounds.
+ */
+static bool validImage(const PackedArrays &t, const int32_t *mapping, int symbols, const int32_t *rules, int nrules) {
+    int gotos = t.columns - t.terminals;
+    if (t.states < 1) return false;
+    for (int s = 0; s < t.states; s++) {
+        if (t.base[s] < 0 || t.base[s] > t.actionSize) return false;
+        if (t.defaultReduce[s] < -1 || t.defaultReduce[s] >= nrules) return false;
+    }
+    for (int i = 0; i < t.actionSize; i++) {
+        if (t.check[i] < -1 || t.check[i] >= t.states) return false;
+        if (!validAction(t.actions[i], t.states, nrules)) return false;
+    }
+    for (int c = 0; c < gotos; c++) {
+        if (t.gotoBase[c] < 0 || t.gotoBase[c] > t.gotoSize) return false;
+        if (!validAction(t.defaultGoto[c], t.states, nrules)) return false;
+    }
+    for (int i = 0; i < t.gotoSize; i++) {
+        if (t.gotoCheck[i] < -1 || t.gotoCheck[i] >= gotos) return false;
+        if (!validAction(t.gotos[i], t.states, nrules)) return false;
+    }
+    for (int i = 0; i < symbols; i++) {
+        if (i > 0 && mapping[2*i] <= mapping[2*i-2]) return false;
+        if (mapping[2*i+1] < 0 || mapping[2*i+1] >= t.columns) return false;
+    }
+    for (int i = 0; i < nrules; i++) {
+        if (rules[2*i+1] < 0) return false;
+    }
+    return true;
+}
+
+TableImage::TableImage(const char *path) {
+    mData = NULL;
+    mSize = 0;
+    mHeader = NULL;
+    mTable = NULL;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= sizeof(TableHeader)) {
+        mSize = st.st_size;
+        mData = mmap(NULL, mSize, PROT_READ, MAP_SHARED, fd, 0);
+        if (mData == MAP_FAILED) mData = NULL;
+    }
+    close(fd);
+    if (!mData) return;
+    const TableHeader *h = (const TableHeader *)mData;
+    if (h->magic != TABLE_IMAGE_MAGIC || h->version != TABLE_IMAGE_VERSION || h->terminals > h->columns) return;
+    uint64_t gotos = h->columns - h->terminals;
+    uint64_t words = 2*(uint64_t)h->states + 2*(uint64_t)h->actionSize + 2*gotos
+        + 2*(uint64_t)h->gotoSize + 2*(uint64_t)h->symbols + 2*(uint64_t)h->rules;
+    if (sizeof(TableHeader) + 4*words != mSize) return;
+    const int32_t *p = (const int32_t *)(h+1);
+    PackedArrays t;
+    t.states = h->states;
+    t.columns = h->columns;
+    t.terminals = h->terminals;
+    t.actionSize = h->actionSize;
+    t.gotoSize = h->gotoSize;
+    t.base = p;                         p += t.states;
+    t.defaultReduce = p;                p += t.states;
+    t.check = p;                        p += t.actionSize;
+    t.actions = (const uint32_t *)p;    p += t.actionSize;
+    t.defaultGoto = (const uint32_t *)p;p += gotos;
+    t.gotoBase = p;                     p += gotos;
+    t.gotoCheck = p;                    p += t.gotoSize;
+    t.gotos = (const uint32_t *)p;      p += t.gotoSize;
+    mMapping = p;                       p += 2*h->symbols;
+    mRules = p;
+    if (!validImage(t, mMapping, h->symbols, mRules, h->rules)) return;
+    mHeader = h;
+    mTable = new PackedTable(t);
+}
+
+TableImage::~TableImage() {
+    delete mTable;
+    if (mData) munmap(mData, mSize);
+}
+
+bool TableImage::valid() {
+    return mTable != NULL;
+}
+
+uint64_t TableImage::hash() {
+    return mHeader->hash;
+}
+
+const PackedTable &TableImage::table() {
+    return *mTable;
+}
+
+//binary search over the mapped (id, column) pairs, -1 for unknown ids
+int TableImage::column(int id) {
+    int lo = 0;
+    int hi = mHeader->symbols;
+    while (lo < hi) {
+        int mid = (lo+hi) / 2;
+        if (mMapping[2*mid] < id) lo = mid+1;
+        else hi = mid;
+    }
+    return lo < mHeader->symbols && mMapping[2*lo] == id ? mMapping[2*lo+1] : -1;
+}
+
+int TableImage::rules() {
+    return mHeader->rules;
+}
+
+int TableImage::ruleFrom(int rule) {
+    return mRules[2*rule];
+}
+
+int TableImage::ruleSize(int rule) {
+    return mRules[2*rule+1];
+}
+
+/*************************************************************
+ *                      CACHE
+*************************************************************/
+/*
+ * Image for the grammar in file, from dir when a previous run already
+ * generated it. A new image is written under a temporary name and renamed
+ * into place, so concurrent processes never see half of one.
+ */
+TableImage *cachedTable(File *file, const char *dir) {
+    uint64_t hash = hashGrammar(file);
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.lrtb", (unsigned long long)hash);
+    string path = string(dir) + name;
+    TableImage *image = new TableImage(path.c_str());
+    if (image->valid() && image->hash() == hash) return image;
+    delete image;
+    LRTable table(file, BUILD_LALR);
+    string temp = path + "." + to_string(getpid());
+    if (!writeTableImage(temp.c_str(), table, hash) || rename(temp.c_str(), path.c_str()) != 0) {
+        unlink(temp.c_str());
+        return NULL;
+    }
+    image = new TableImage(path.c_str());
+    if (image->valid()) return image;
+    delete image;
+    return NULL;
+}
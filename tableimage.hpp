@@ -0,0 +1,64 @@
+#ifndef TABLE_IMAGE_HPP
+#define TABLE_IMAGE_HPP
+
+#include "lrgen.hpp"
+#include "packedtable.hpp"
+
+/*
+ * Binary table image, laid out to be mapped and used in place:
+ *
+ *   TableHeader
+ *   int32  base[states]            int32  defaultReduce[states]
+ *   int32  check[actionSize]       uint32 actions[actionSize]
+ *   uint32 defaultGoto[gotos]      int32  gotoBase[gotos]
+ *   int32  gotoCheck[gotoSize]     uint32 gotoActions[gotoSize]
+ *   int32  mapping[symbols][2]     id, column, sorted by id
+ *   int32  rules[rules][2]         left side id, right side length
+ *
+ * gotos is columns-terminals. Every array is 4 byte aligned.
+ */
+#define TABLE_IMAGE_MAGIC 0x4254524c    //"LRTB"
+#define TABLE_IMAGE_VERSION 2
+
+struct TableHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t hash;          //hashGrammar() of the source
+    uint32_t states;
+    uint32_t columns;
+    uint32_t terminals;
+    uint32_t actionSize;
+    uint32_t gotoSize;
+    uint32_t symbols;
+    uint32_t rules;
+    uint32_t reserved;
+};
+
+uint64_t hashGrammar(File *file);
+bool writeTableImage(const char *path, LRTable &table, uint64_t hash);
+
+//read-only mapping of a table image, checked when opened
+class TableImage {
+private:
+    void *mData;
+    size_t mSize;
+    const TableHeader *mHeader;
+    const int32_t *mMapping;
+    const int32_t *mRules;
+    PackedTable *mTable;
+public:
+    TableImage(const char *path);
+    ~TableImage();
+    TableImage(const TableImage &) = delete;
+    bool valid();
+    uint64_t hash();
+    const PackedTable &table();
+    int column(int id);
+    int rules();
+    int ruleFrom(int rule);
+    int ruleSize(int rule);
+};
+
+TableImage *cachedTable(File *file, const char *dir);
+
+#endif
@@ -0,0 +1,15 @@
+#define ID      0
+#define TO      1
+#define RET     2
+#define END     3
+#define F       4
+#define L       5
+#define E       6
+#define FP      7
+//   /[0-9]+ >   \n  $   |   F   L   E
+/FP>/F/END
+/F>/L
+/F>/L/RET/F
+/L>/ID/TO/E
+/E>/ID/E
+/E>/ID
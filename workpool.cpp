@@ -0,0 +1,87 @@
+#include "workpool.hpp"
+
+WorkPool::WorkPool(int threads) : mQueues(threads < 1 ? 1 : threads), mQueueLocks(mQueues.size()) {
+    mGeneration = 0;
+    mRunning = 0;
+    mStop = false;
+    for (int i = 1; i < mQueues.size(); i++) {
+        mThreads.push_back(thread(&WorkPool::loop, this, i));
+    }
+}
+
+WorkPool::~WorkPool() {
+    {
+        lock_guard<mutex> guard(mLock);
+        mStop = true;
+    }
+    mWake.notify_all();
+    for (int i = 0; i < mThreads.size(); i++) {
+        mThreads[i].join();
+    }
+}
+
+int WorkPool::size() {
+    return mQueues.size();
+}
+
+bool WorkPool::take(int worker, int &task) {
+    {
+        lock_guard<mutex> guard(mQueueLocks[worker]);
+        if (!mQueues[worker].empty()) {
+            task = mQueues[worker].back();
+            mQueues[worker].pop_back();
+            return true;
+        }
+    }
+    for (int i = 1; i < mQueues.size(); i++) {
+        int victim = (worker+i) % mQueues.size();
+        lock_guard<mutex> guard(mQueueLocks[victim]);
+        if (mQueues[victim].empty()) continue;
+        task = mQueues[victim].front();
+        mQueues[victim].pop_front();
+        return true;
+    }
+    return false;
+}
+
+//no task is queued after a batch starts, so empty queues mean done
+void WorkPool::work(int worker) {
+    int task;
+    while (take(worker, task)) mTask(task, worker);
+    lock_guard<mutex> guard(mLock);
+    if (--mRunning == 0) mDone.notify_all();
+}
+
+void WorkPool::loop(int worker) {
+    int seen = 0;
+    while (1) {
+        {
+            unique_lock<mutex> guard(mLock);
+            mWake.wait(guard, [&] { return mStop || mGeneration != seen; });
+            if (mStop) return;
+            seen = mGeneration;
+        }
+        work(worker);
+    }
+}
+
+//runs task(0) ... task(tasks-1) and returns once all of them finished
+void WorkPool::run(int tasks, function<void(int)> task) {
+    run(tasks, [&](int i, int) { task(i); });
+}
+
+void WorkPool::run(int tasks, function<void(int, int)> task) {
+    mTask = task;
+    for (int i = 0; i < tasks; i++) {
+        mQueues[i * mQueues.size() / tasks].push_back(i);
+    }
+    {
+        lock_guard<mutex> guard(mLock);
+        mRunning = mQueues.size();
+        mGeneration++;
+    }
+    mWake.notify_all();
+    work(0);
+    unique_lock<mutex> guard(mLock);
+    mDone.wait(guard, [&] { return mRunning == 0; });
+}
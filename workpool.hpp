@@ -0,0 +1,44 @@
+#ifndef WORKPOOL_HPP
+#define WORKPOOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+/*
+ * Fixed set of worker threads running batches of independent tasks.
+ * Each worker owns a deque of task numbers, pops from its back and
+ * steals from the front of the others once it runs dry. The calling
+ * thread takes part as worker 0, so a pool of size 1 runs inline. Tasks
+ * that keep per worker state can ask for the number of their worker.
+ */
+class WorkPool {
+private:
+    vector<thread> mThreads;
+    vector<deque<int>> mQueues;
+    vector<mutex> mQueueLocks;
+    function<void(int, int)> mTask;
+    mutex mLock;
+    condition_variable mWake;
+    condition_variable mDone;
+    int mGeneration;
+    int mRunning;
+    bool mStop;
+    bool take(int worker, int &task);
+    void work(int worker);
+    void loop(int worker);
+public:
+    WorkPool(int threads);
+    ~WorkPool();
+    void run(int tasks, function<void(int)> task);
+    //task(i, worker), worker in 0 ... size()-1
+    void run(int tasks, function<void(int, int)> task);
+    int size();
+};
+
+#endif